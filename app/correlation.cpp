@@ -0,0 +1,302 @@
+#include "correlation.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+#include <thread>
+
+namespace {
+    // Independent accumulator lanes let the compiler vectorise the reduction
+    // without reassociating floating point additions itself
+    const size_t kLanes = 4;
+
+    // Below this much work per lag sweep, threads cost more than they save
+    const size_t kParallelThreshold = 1 << 16;
+
+    // Refuse grids that would allocate unreasonable amounts of memory
+    const size_t kMaxGridBuckets = 50000000;
+
+    const double kNaN = std::numeric_limits<double>::quiet_NaN();
+
+    void requireSorted(const Correlation::Series& series) {
+        if (series.times.size() != series.values.size()) {
+            throw std::invalid_argument("Series " + series.name + " has mismatched times and values");
+        }
+        if (!std::is_sorted(series.times.begin(), series.times.end())) {
+            throw std::invalid_argument("Series " + series.name + " is not sorted by time");
+        }
+    }
+
+    std::vector<double> centred(const std::vector<double>& values) {
+        double mean = values.empty() ? 0.0
+                                     : std::accumulate(values.begin(), values.end(), 0.0) / values.size();
+        std::vector<double> result(values.size());
+        for (size_t i = 0; i < values.size(); ++i) {
+            result[i] = values[i] - mean;
+        }
+        return result;
+    }
+}
+
+Correlation::AlignedSeries Correlation::alignWithTolerance(const std::vector<Series>& series,
+                                                           int64_t toleranceMicros) {
+    AlignedSeries aligned;
+    if (series.empty()) return aligned;
+
+    for (const auto& s : series) {
+        requireSorted(s);
+        aligned.names.push_back(s.name);
+    }
+    aligned.columns.resize(series.size());
+
+    // Merge join: one cursor per series, each only ever moves forward
+    const Series& reference = series.front();
+    std::vector<size_t> cursors(series.size(), 0);
+    std::vector<double> row(series.size());
+
+    for (size_t r = 0; r < reference.times.size(); ++r) {
+        int64_t t = reference.times[r];
+        row[0] = reference.values[r];
+        bool matched = true;
+
+        for (size_t s = 1; s < series.size() && matched; ++s) {
+            const std::vector<int64_t>& times = series[s].times;
+            size_t& j = cursors[s];
+            if (times.empty()) {
+                matched = false;
+                break;
+            }
+
+            // Advance to the sample nearest t
+            while (j + 1 < times.size() && std::llabs(times[j + 1] - t) <= std::llabs(times[j] - t)) {
+                ++j;
+            }
+            matched = std::llabs(times[j] - t) <= toleranceMicros;
+            row[s] = series[s].values[j];
+        }
+
+        if (!matched) continue;
+        aligned.times.push_back(t);
+        for (size_t s = 0; s < series.size(); ++s) {
+            aligned.columns[s].push_back(row[s]);
+        }
+    }
+    return aligned;
+}
+
+Correlation::AlignedSeries Correlation::resampleToGrid(const std::vector<Series>& series, int64_t stepMicros) {
+    AlignedSeries aligned;
+    if (series.empty()) return aligned;
+    if (stepMicros <= 0) {
+        throw std::invalid_argument("Grid step must be positive");
+    }
+
+    // The grid covers only the span where every series has data
+    int64_t start = std::numeric_limits<int64_t>::min();
+    int64_t end = std::numeric_limits<int64_t>::max();
+    for (const auto& s : series) {
+        requireSorted(s);
+        aligned.names.push_back(s.name);
+        if (s.times.empty()) return aligned;
+        start = std::max(start, s.times.front());
+        end = std::min(end, s.times.back());
+    }
+    if (start > end) return aligned;
+
+    size_t buckets = static_cast<size_t>((end - start) / stepMicros) + 1;
+    if (buckets > kMaxGridBuckets) {
+        throw std::invalid_argument("Grid step is too small for the time span of the data");
+    }
+
+    aligned.times.resize(buckets);
+    for (size_t b = 0; b < buckets; ++b) {
+        aligned.times[b] = start + static_cast<int64_t>(b) * stepMicros;
+    }
+
+    std::vector<double> sums(buckets);
+    std::vector<uint32_t> counts(buckets);
+    for (const auto& s : series) {
+        std::fill(sums.begin(), sums.end(), 0.0);
+        std::fill(counts.begin(), counts.end(), 0);
+
+        // Samples before the grid seed the carried-forward value
+        double last = kNaN;
+        for (size_t i = 0; i < s.times.size(); ++i) {
+            int64_t t = s.times[i];
+            if (t < start) {
+                last = s.values[i];
+                continue;
+            }
+            if (t > end) break;
+            size_t b = static_cast<size_t>((t - start) / stepMicros);
+            sums[b] += s.values[i];
+            ++counts[b];
+        }
+
+        std::vector<double> column(buckets);
+        for (size_t b = 0; b < buckets; ++b) {
+            if (counts[b]) last = sums[b] / counts[b];
+            column[b] = last;
+        }
+        aligned.columns.push_back(std::move(column));
+    }
+    return aligned;
+}
+
+double Correlation::centredPearson(const double* x, const double* y, size_t n) {
+    if (n < 2) return kNaN;
+
+    double sx[kLanes] = {}, sy[kLanes] = {}, sxx[kLanes] = {}, syy[kLanes] = {}, sxy[kLanes] = {};
+    size_t i = 0;
+    for (; i + kLanes <= n; i += kLanes) {
+        for (size_t l = 0; l < kLanes; ++l) {
+            double a = x[i + l];
+            double b = y[i + l];
+            sx[l] += a;
+            sy[l] += b;
+            sxx[l] += a * a;
+            syy[l] += b * b;
+            sxy[l] += a * b;
+        }
+    }
+    for (; i < n; ++i) {
+        sx[0] += x[i];
+        sy[0] += y[i];
+        sxx[0] += x[i] * x[i];
+        syy[0] += y[i] * y[i];
+        sxy[0] += x[i] * y[i];
+    }
+
+    double Sx = 0, Sy = 0, Sxx = 0, Syy = 0, Sxy = 0;
+    for (size_t l = 0; l < kLanes; ++l) {
+        Sx += sx[l];
+        Sy += sy[l];
+        Sxx += sxx[l];
+        Syy += syy[l];
+        Sxy += sxy[l];
+    }
+
+    // Inputs are centred on the full series, so these sums stay well conditioned
+    // even for windows whose own mean differs slightly
+    double count = static_cast<double>(n);
+    double cov = count * Sxy - Sx * Sy;
+    double varX = count * Sxx - Sx * Sx;
+    double varY = count * Syy - Sy * Sy;
+    if (varX <= 0.0 || varY <= 0.0) return kNaN;
+    return cov / std::sqrt(varX * varY);
+}
+
+double Correlation::pearson(const std::vector<double>& x, const std::vector<double>& y) {
+    if (x.size() != y.size()) {
+        throw std::invalid_argument("Pearson correlation needs series of equal length");
+    }
+    std::vector<double> cx = centred(x);
+    std::vector<double> cy = centred(y);
+    return centredPearson(cx.data(), cy.data(), cx.size());
+}
+
+std::vector<double> Correlation::ranks(const std::vector<double>& values) {
+    std::vector<size_t> order(values.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&values](size_t a, size_t b) { return values[a] < values[b]; });
+
+    // Tied values share the average of the ranks they span
+    std::vector<double> result(values.size());
+    for (size_t i = 0; i < order.size();) {
+        size_t j = i;
+        while (j + 1 < order.size() && values[order[j + 1]] == values[order[i]]) ++j;
+        double rank = (i + j) / 2.0 + 1.0;
+        for (size_t k = i; k <= j; ++k) {
+            result[order[k]] = rank;
+        }
+        i = j + 1;
+    }
+    return result;
+}
+
+double Correlation::spearman(const std::vector<double>& x, const std::vector<double>& y) {
+    return pearson(ranks(x), ranks(y));
+}
+
+std::vector<std::vector<double>> Correlation::covarianceMatrix(const AlignedSeries& aligned) {
+    size_t fields = aligned.columns.size();
+    size_t n = aligned.times.size();
+    std::vector<std::vector<double>> matrix(fields, std::vector<double>(fields, kNaN));
+    if (n < 2) return matrix;
+
+    std::vector<std::vector<double>> centredColumns;
+    centredColumns.reserve(fields);
+    for (const auto& column : aligned.columns) {
+        centredColumns.push_back(centred(column));
+    }
+
+    for (size_t a = 0; a < fields; ++a) {
+        for (size_t b = a; b < fields; ++b) {
+            const double* x = centredColumns[a].data();
+            const double* y = centredColumns[b].data();
+            double lanes[kLanes] = {};
+            size_t i = 0;
+            for (; i + kLanes <= n; i += kLanes) {
+                for (size_t l = 0; l < kLanes; ++l) {
+                    lanes[l] += x[i + l] * y[i + l];
+                }
+            }
+            for (; i < n; ++i) {
+                lanes[0] += x[i] * y[i];
+            }
+
+            double sum = std::accumulate(lanes, lanes + kLanes, 0.0);
+            matrix[a][b] = matrix[b][a] = sum / (n - 1);
+        }
+    }
+    return matrix;
+}
+
+std::vector<double> Correlation::crossCorrelation(const std::vector<double>& x, const std::vector<double>& y,
+                                                  int maxLag) {
+    if (x.size() != y.size()) {
+        throw std::invalid_argument("Cross-correlation needs series of equal length");
+    }
+    if (maxLag < 0) maxLag = 0;
+
+    std::vector<double> cx = centred(x);
+    std::vector<double> cy = centred(y);
+    size_t n = cx.size();
+    size_t lagCount = 2 * static_cast<size_t>(maxLag) + 1;
+    std::vector<double> result(lagCount, kNaN);
+
+    auto computeLags = [&](size_t first, size_t last) {
+        for (size_t index = first; index < last; ++index) {
+            long long lag = static_cast<long long>(index) - maxLag;
+            size_t shift = static_cast<size_t>(std::llabs(lag));
+            if (shift >= n) continue;
+
+            // Positive lags compare x[t] with y[t + lag]
+            const double* xs = lag >= 0 ? cx.data() : cx.data() + shift;
+            const double* ys = lag >= 0 ? cy.data() + shift : cy.data();
+            result[index] = centredPearson(xs, ys, n - shift);
+        }
+    };
+
+    unsigned threadCount = std::thread::hardware_concurrency();
+    if (n * lagCount < kParallelThreshold || threadCount < 2 || lagCount < 2) {
+        computeLags(0, lagCount);
+        return result;
+    }
+
+    // Each thread owns a contiguous block of lags and writes only its own slots
+    threadCount = static_cast<unsigned>(std::min<size_t>(threadCount, lagCount));
+    size_t chunk = (lagCount + threadCount - 1) / threadCount;
+    std::vector<std::thread> workers;
+    for (unsigned t = 0; t < threadCount; ++t) {
+        size_t first = t * chunk;
+        if (first >= lagCount) break;
+        workers.emplace_back(computeLags, first, std::min(lagCount, first + chunk));
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    return result;
+}
@@ -0,0 +1,47 @@
+#ifndef CORRELATION_H
+#define CORRELATION_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+class Correlation {
+public:
+    // One field sampled over time; times are microseconds since the epoch, ascending
+    struct Series {
+        std::string name;
+        std::vector<int64_t> times;
+        std::vector<double> values;
+    };
+
+    // Several fields sharing a single time axis
+    struct AlignedSeries {
+        std::vector<std::string> names;
+        std::vector<int64_t> times;
+        std::vector<std::vector<double>> columns;  // One column per field, each times.size() long
+    };
+
+    // Pair each sample of the first series with the nearest sample of every other
+    // series within the tolerance; rows without a match in all series are dropped
+    static AlignedSeries alignWithTolerance(const std::vector<Series>& series, int64_t toleranceMicros);
+
+    // Average every series into fixed-width time buckets, carrying the last value
+    // forward across empty buckets so lags stay evenly spaced
+    static AlignedSeries resampleToGrid(const std::vector<Series>& series, int64_t stepMicros);
+
+    static double pearson(const std::vector<double>& x, const std::vector<double>& y);
+    static double spearman(const std::vector<double>& x, const std::vector<double>& y);
+    static std::vector<std::vector<double>> covarianceMatrix(const AlignedSeries& aligned);
+
+    // Pearson correlation of x[t] against y[t + lag] for every lag in [-maxLag, maxLag]
+    static std::vector<double> crossCorrelation(const std::vector<double>& x, const std::vector<double>& y,
+                                                int maxLag);
+
+private:
+    // Pearson correlation over n samples of two pre-centred arrays
+    static double centredPearson(const double* x, const double* y, size_t n);
+    static std::vector<double> ranks(const std::vector<double>& values);
+};
+
+#endif // CORRELATION_H
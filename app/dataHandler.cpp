@@ -3,78 +3,95 @@
 #include <stdexcept>
 #include <mariadb/mysql.h>
 #include <limits>
-#include <ctime>
 #include <sstream>
 #include <algorithm>
 #include <cmath>
 #include <functional>
+#include <iomanip>
 #include <numeric>
 
-DataHandler::DataHandler(DatabaseConnector* dbConnector) : dbConnector(dbConnector) {}
+namespace {
+    // First arena block per analysis; sized for the default 1000-row fetch of a few fields
+    const size_t kArenaInitialBytes = 64 * 1024;
 
-void DataHandler::printTableHeaders() {
-    try {
-        MYSQL* conn = dbConnector->getConnection();
-        if (!conn) {
-            std::cerr << "Database connection is null." << std::endl;
-            return;
-        }
+    // Per-field cap for correlation; a window is trimmed to its most recent rows beyond this
+    const size_t kCorrelationRowLimit = 200000;
 
-        const std::string query = "SHOW COLUMNS FROM laser_data"; // Modify the table name if needed
-        if (mysql_query(conn, query.c_str())) {
-            std::cerr << "Query failed: " << mysql_error(conn) << "\nQuery: " << query << std::endl;
-            return;
-        }
+    // Window start shown to the query advisor; any literal gives the same plan shape
+    const char* kSampleWindowStart = "2000-01-01 00:00:00";
+}
 
-        MYSQL_RES* res = mysql_store_result(conn);
-        if (!res) {
-            std::cerr << "Failed to retrieve result: " << mysql_error(conn) << std::endl;
-            return;
-        }
+DataHandler::DataHandler(DatabaseConnector* dbConnector, SchemaCache* schemaCache)
+    : dbConnector(dbConnector), schemaCache(schemaCache) {}
 
-        std::cout << "Available fields in the table:\n";
-        MYSQL_ROW row;
-        while ((row = mysql_fetch_row(res))) {
-            std::cout << row[0] << std::endl; // Column name
+void DataHandler::printTableHeaders() {
+    // Cached metadata only annotates the list; a missing or loading cache never blocks it
+    bool haveSchema = schemaCache && schemaCache->isLoaded();
+
+    std::cout << "Available fields in the table:\n";
+    for (const auto& field : LaserDataFields::descriptors()) {
+        std::cout << field.name << " (" << field.unit << ")";
+        if (haveSchema && !schemaCache->hasColumn("laser_data", field.name)) {
+            std::cout << " [missing from laser_data]";
         }
+        std::cout << std::endl;
+    }
 
-        mysql_free_result(res);
-    } catch (const std::exception& e) {
-        std::cerr << "Unexpected error in printTableHeaders: " << e.what() << std::endl;
+    if (schemaCache) {
+        schemaCache->refreshIfStale(dbConnector);
     }
 }
 
 
 std::string DataHandler::lastGraphType = "";
 
-std::vector<std::pair<std::string, double>> DataHandler::fetchPowerData() {
-    auto rawData = fetchDataFromDatabase("SELECT timestamp, powerReading FROM laser_data ORDER BY timestamp ASC LIMIT 1000");
+std::string DataHandler::buildFieldQuery(const std::string& field) {
+    return "SELECT timestamp, " + field + " FROM laser_data ORDER BY timestamp ASC LIMIT 1000";
+}
 
-    // Convert W to mW
-    for (auto& entry : rawData) {
-        entry.second /= 1000.0;  // 1 W = 1000 mW
+std::string DataHandler::buildWindowQuery(const std::string& field, const std::string& windowStart,
+                                          size_t rowLimit) {
+    // Rows come back newest first, which an index on (timestamp, field) serves directly
+    std::ostringstream query;
+    query << "SELECT timestamp, " << field << " FROM laser_data WHERE " << field << " IS NOT NULL";
+    if (!windowStart.empty()) {
+        query << " AND timestamp >= '" << windowStart << "'";
     }
-
-    return rawData;
+    query << " ORDER BY timestamp DESC LIMIT " << rowLimit;
+    return query.str();
 }
 
-std::vector<std::pair<std::string, double>> DataHandler::fetchFlowRateData() {
-    auto rawData = fetchDataFromDatabase("SELECT timestamp, flowRate FROM laser_data ORDER BY timestamp ASC LIMIT 1000");
-
-    // Convert ml to L
-    for (auto& entry : rawData) {
-        entry.second /= 1000.0;  // 1 L = 1000 ml
+std::vector<std::string> DataHandler::generatedQueries() {
+    std::vector<std::string> queries;
+    for (const auto& field : LaserDataFields::descriptors()) {
+        queries.push_back(buildFieldQuery(field.name));
+        queries.push_back(buildWindowQuery(field.name, kSampleWindowStart, kCorrelationRowLimit));
     }
+    return queries;
+}
 
-    return rawData;
+bool DataHandler::findField(const std::string& name, FieldDescriptor& descriptor) {
+    return FieldDispatcher<LaserDataFields>::dispatch(name, [&descriptor](auto field) {
+        descriptor = decltype(field)::descriptor();
+    });
 }
 
-std::vector<std::pair<std::string, double>> DataHandler::fetchFrequencyData() {
-    return fetchDataFromDatabase("SELECT timestamp, frequency FROM laser_data ORDER BY timestamp ASC LIMIT 1000");
+SampleSeries DataHandler::fetchField(const std::string& name, const std::string& query,
+                                     std::pmr::memory_resource* arena) {
+    SampleSeries data(arena);
+    bool known = FieldDispatcher<LaserDataFields>::dispatch(name, [this, &query, arena, &data](auto field) {
+        data = fetchDataFromDatabase<decltype(field)>(query, arena);
+    });
+
+    if (!known) {
+        std::cerr << "Unknown field: " << name << std::endl;
+    }
+    return data;
 }
 
-std::vector<std::pair<std::string, double>> DataHandler::fetchDataFromDatabase(const std::string& query) {
-    std::vector<std::pair<std::string, double>> data;
+template <typename Field>
+SampleSeries DataHandler::fetchDataFromDatabase(const std::string& query, std::pmr::memory_resource* arena) {
+    SampleSeries data(arena);
 
     try {
         MYSQL* conn = dbConnector->getConnection();
@@ -95,20 +112,26 @@ std::vector<std::pair<std::string, double>> DataHandler::fetchDataFromDatabase(c
             return data;
         }
 
+        // Size the series once from the row count so the loop below never reallocates
+        data.reserve(mysql_num_rows(res));
         MYSQL_ROW row;
         while ((row = mysql_fetch_row(res))) {
-            try {
-                if (!row[0] || !row[1]) {
-                    std::cerr << "Null or invalid row encountered. Skipping..." << std::endl;
-                    continue;
-                }
-
-                std::string timestamp = row[0];
-                double value = std::stod(row[1]); // Directly convert; assumes clean query results
-                data.emplace_back(timestamp, value);
-            } catch (const std::exception& e) {
-                std::cerr << "Invalid data format encountered: " << e.what() << ". Skipping row." << std::endl;
+            if (!row[0] || !row[1]) {
+                std::cerr << "Null or invalid row encountered. Skipping..." << std::endl;
+                continue;
             }
+
+            // Decode straight from the row buffer; nothing is allocated per row
+            Sample sample;
+            if (!parseTimestamp(row[0], sample.timestamp)) {
+                std::cerr << "Error processing timestamp: " << row[0] << ". Skipping row." << std::endl;
+                continue;
+            }
+            if (!decodeField<Field>(row[1], sample.value)) {
+                std::cerr << "Invalid data format encountered: " << row[1] << ". Skipping row." << std::endl;
+                continue;
+            }
+            data.push_back(sample);
         }
 
         mysql_free_result(res);
@@ -121,63 +144,68 @@ std::vector<std::pair<std::string, double>> DataHandler::fetchDataFromDatabase(c
 
 
 
-std::vector<std::pair<double, double>> DataHandler::preprocessData(
-    const std::vector<std::pair<std::string, double>>& rawData) {
-    std::vector<std::pair<double, double>> processedData;
+std::pmr::vector<std::pair<double, double>> DataHandler::preprocessData(const SampleSeries& rawData) {
+    // Allocate from the same arena as the raw data
+    std::pmr::vector<std::pair<double, double>> processedData(rawData.get_allocator());
 
     if (rawData.empty()) return processedData;
 
-    // Parse the first timestamp to use as a reference point
-    auto firstTimestamp = parseTimestamp(rawData.front().first);  // Parse the string timestamp into time_point
+    // Use the first timestamp as a reference point
+    int64_t firstTimestamp = rawData.front().timestamp;
+    processedData.reserve(rawData.size());
 
     for (const auto& entry : rawData) {
-        try {
-            auto currentTimestamp = parseTimestamp(entry.first);  // Parse each timestamp to time_point
-
-            // Calculate time difference in seconds
-            double timeDiff = std::chrono::duration<double>(
-                currentTimestamp - firstTimestamp
-            ).count();
-
-            processedData.emplace_back(timeDiff, entry.second);
-        } catch (const std::exception& e) {
-            std::cerr << "Error processing timestamp: " << e.what()
-                      << " for timestamp: " << entry.first << std::endl;
-        }
+        // Calculate time difference in seconds
+        double timeDiff = (entry.timestamp - firstTimestamp) / 1e6;
+        processedData.emplace_back(timeDiff, entry.value);
     }
 
     return processedData;
 }
 
-std::chrono::system_clock::time_point DataHandler::parseTimestamp(const std::string& timestampStr) {
-    std::tm tm = {};
-    std::istringstream ss(timestampStr);
-
-    // Use strptime for more reliable parsing (POSIX method)
-    if (strptime(timestampStr.c_str(), "%Y-%m-%d %H:%M:%S", &tm) == nullptr) {
-        throw std::runtime_error("Failed to parse timestamp: " + timestampStr);
+bool DataHandler::parseTimestamp(const char* text, int64_t& micros) {
+    // Fixed-width "YYYY-MM-DD HH:MM:SS[.ffffff]" as returned for DATETIME/TIMESTAMP columns
+    auto digits = [text](int offset, int count, int& value) {
+        value = 0;
+        for (int i = 0; i < count; ++i) {
+            char c = text[offset + i];
+            if (c < '0' || c > '9') return false;
+            value = value * 10 + (c - '0');
+        }
+        return true;
+    };
+
+    int year, month, day, hour, minute, second;
+    if (!digits(0, 4, year) || text[4] != '-' || !digits(5, 2, month) || text[7] != '-' ||
+        !digits(8, 2, day) || (text[10] != ' ' && text[10] != 'T') || !digits(11, 2, hour) ||
+        text[13] != ':' || !digits(14, 2, minute) || text[16] != ':' || !digits(17, 2, second)) {
+        return false;
     }
-
-    // Convert to time_t
-    tm.tm_isdst = -1;  // Let the system determine daylight saving time
-    std::time_t time = std::mktime(&tm);
-
-    // Handle microseconds if present
-    size_t dotPos = timestampStr.find('.');
-    int microseconds = 0;
-    if (dotPos != std::string::npos) {
-        try {
-            microseconds = std::stoi(timestampStr.substr(dotPos + 1));
-        } catch (...) {
-            // Ignore if microseconds can't be parsed
+    if (month < 1 || month > 12 || day < 1 || day > 31) return false;
+
+    // Fractional seconds may have up to six digits
+    int fraction = 0;
+    if (text[19] == '.') {
+        int i = 20;
+        for (; i < 26 && text[i] >= '0' && text[i] <= '9'; ++i) {
+            fraction = fraction * 10 + (text[i] - '0');
+        }
+        for (; i < 26; ++i) {
+            fraction *= 10;
         }
     }
 
-    // Convert to system_clock time point
-    auto timePoint = std::chrono::system_clock::from_time_t(time);
-    timePoint += std::chrono::microseconds(microseconds);
-
-    return timePoint;
+    // Days since 1970-01-01 in the proleptic Gregorian calendar, treating the value as UTC
+    int y = year - (month <= 2);
+    int era = (y >= 0 ? y : y - 399) / 400;
+    int yearOfEra = y - era * 400;
+    int dayOfYear = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+    int dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+    int64_t days = static_cast<int64_t>(era) * 146097 + dayOfEra - 719468;
+
+    micros = ((days * 24 + hour) * 60 + minute) * 60 + second;
+    micros = micros * 1000000 + fraction;
+    return true;
 }
 
 void DataHandler::analyzeField() {
@@ -185,17 +213,24 @@ void DataHandler::analyzeField() {
     printTableHeaders();
 
     // Prompt user to select a field
-    std::string field;
+    std::string fieldName;
     std::cout << "\nEnter the field name you want to analyze: ";
-    std::cin >> field;
+    std::cin >> fieldName;
 
-    std::cout << "Testing analysis for field: " << field << std::endl;
+    // Only registry fields are accepted, so user input never reaches the SQL text
+    FieldDescriptor field;
+    if (!findField(fieldName, field)) {
+        std::cout << "Unknown field: " << fieldName << std::endl;
+        return;
+    }
+
+    std::cout << "Testing analysis for field: " << field.name << " (" << field.unit << ")" << std::endl;
 
-    // Construct a dynamic query based on the selected field
-    std::string query = "SELECT timestamp, " + field + " FROM laser_data ORDER BY timestamp ASC LIMIT 1000";
-    
-    // Fetch data using a generic method
-    auto rawData = fetchDataFromDatabase(query);
+    // Everything decoded for this analysis lives in one arena, freed in one go on return
+    std::pmr::monotonic_buffer_resource arena(kArenaInitialBytes);
+
+    // Fetch data through the field's typed decode path
+    SampleSeries rawData = fetchField(field.name, buildFieldQuery(field.name), &arena);
 
     if (rawData.empty()) {
         std::cout << "No data found for the specified field." << std::endl;
@@ -203,9 +238,10 @@ void DataHandler::analyzeField() {
     }
 
     // Extract values from fetched data
-    std::vector<double> values;
+    std::pmr::vector<double> values(&arena);
+    values.reserve(rawData.size());
     for (const auto& entry : rawData) {
-        values.push_back(entry.second);
+        values.push_back(entry.value);
     }
 
     int analysisChoice;
@@ -215,6 +251,8 @@ void DataHandler::analyzeField() {
     std::cout << "3. Median\n";
     std::cout << "4. Standard Deviation\n";
     std::cout << "5. Outliers\n";
+    std::cout << "6. Histogram\n";
+    std::cout << "7. Full-table Histogram (server-side)\n";
     std::cout << "Please select an option: ";
     std::cin >> analysisChoice;
 
@@ -234,24 +272,30 @@ void DataHandler::analyzeField() {
         case 5:
             identifyOutliers(values);
             break;
+        case 6:
+            showHistogram(values);
+            break;
+        case 7:
+            showServerHistogram(field);
+            break;
         default:
             std::cout << "Invalid choice." << std::endl;
             break;
     }
 }
 
-void DataHandler::calculateRange(const std::vector<double>& values) {
+void DataHandler::calculateRange(const std::pmr::vector<double>& values) {
     auto minMax = std::minmax_element(values.begin(), values.end());
     std::cout << "Range: " << *minMax.second - *minMax.first << std::endl;
 }
 
-void DataHandler::calculateMean(const std::vector<double>& values) {
+void DataHandler::calculateMean(const std::pmr::vector<double>& values) {
     double sum = std::accumulate(values.begin(), values.end(), 0.0);
     double mean = sum / values.size();
     std::cout << "Mean: " << mean << std::endl;
 }
 
-void DataHandler::calculateMedian(std::vector<double>& values) {
+void DataHandler::calculateMedian(std::pmr::vector<double>& values) {
     std::sort(values.begin(), values.end());
     size_t size = values.size();
     double median = (size % 2 == 0)
@@ -260,7 +304,7 @@ void DataHandler::calculateMedian(std::vector<double>& values) {
     std::cout << "Median: " << median << std::endl;
 }
 
-void DataHandler::calculateStandardDeviation(const std::vector<double>& values) {
+void DataHandler::calculateStandardDeviation(const std::pmr::vector<double>& values) {
     double mean = std::accumulate(values.begin(), values.end(), 0.0) / values.size();
     double sumSquaredDiffs = 0.0;
     for (double value : values) {
@@ -270,7 +314,7 @@ void DataHandler::calculateStandardDeviation(const std::vector<double>& values)
     std::cout << "Standard Deviation: " << stdDev << std::endl;
 }
 
-void DataHandler::identifyOutliers(const std::vector<double>& values) {
+void DataHandler::identifyOutliers(const std::pmr::vector<double>& values) {
     double mean = std::accumulate(values.begin(), values.end(), 0.0) / values.size();
     double stdDev = 0;
     for (double value : values) {
@@ -285,3 +329,314 @@ void DataHandler::identifyOutliers(const std::vector<double>& values) {
         }
     }
 }
+
+void DataHandler::showHistogram(const std::pmr::vector<double>& values) {
+    int modeChoice;
+    std::cout << "\nChoose a binning mode:\n";
+    std::cout << "1. Fixed width\n";
+    std::cout << "2. Log scale\n";
+    std::cout << "3. Quantile\n";
+    std::cout << "Please select an option: ";
+    std::cin >> modeChoice;
+
+    Histogram::BinMode mode;
+    switch (modeChoice) {
+        case 1:
+            mode = Histogram::BinMode::FixedWidth;
+            break;
+        case 2:
+            mode = Histogram::BinMode::LogScale;
+            break;
+        case 3:
+            mode = Histogram::BinMode::Quantile;
+            break;
+        default:
+            std::cout << "Invalid choice." << std::endl;
+            return;
+    }
+
+    int binCount;
+    std::cout << "Enter the number of bins (1-100): ";
+    if (!(std::cin >> binCount) || binCount < 1 || binCount > 100) {
+        std::cin.clear();
+        std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+        std::cout << "Invalid number of bins." << std::endl;
+        return;
+    }
+
+    Histogram histogram(mode, static_cast<size_t>(binCount));
+    histogram.build(values.data(), values.size());
+    histogram.print(std::cout);
+}
+
+void DataHandler::showServerHistogram(const FieldDescriptor& field) {
+    double width;
+    std::cout << "Enter the bin width: ";
+    if (!(std::cin >> width) || !(width > 0.0)) {
+        std::cin.clear();
+        std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+        std::cout << "Bin width must be a positive number." << std::endl;
+        return;
+    }
+
+    auto bins = fetchServerHistogram(field, width);
+    if (bins.empty()) {
+        std::cout << "No data found for the specified field." << std::endl;
+        return;
+    }
+
+    Histogram histogram(Histogram::BinMode::FixedWidth, 1);
+    if (bins.size() > Histogram::kMaxServerBins || !histogram.loadServerBins(bins, width)) {
+        std::cout << "Bin width is too small: the data spans more than " << Histogram::kMaxServerBins
+                  << " bins. Please choose a wider bin." << std::endl;
+        return;
+    }
+    histogram.print(std::cout);
+}
+
+std::vector<std::pair<long long, uint64_t>> DataHandler::fetchServerHistogram(const FieldDescriptor& field, double width) {
+    std::vector<std::pair<long long, uint64_t>> bins;
+
+    try {
+        MYSQL* conn = dbConnector->getConnection();
+        if (!conn) {
+            std::cerr << "Database connection is null." << std::endl;
+            return bins;
+        }
+
+        // Let the server bin the whole table so only one row per bin crosses the wire;
+        // the width is in display units, so scale the stored value first
+        std::ostringstream query;
+        query.precision(17);
+        // FLOOR of a DOUBLE is a DOUBLE and may print in exponent form, so cast to an integer;
+        // one row past the limit is enough to tell the caller the width is too small
+        query << "SELECT CAST(FLOOR(" << field.name << " * " << field.scale << " / " << width
+              << ") AS SIGNED) AS bin, COUNT(*) FROM laser_data"
+              << " WHERE " << field.name << " IS NOT NULL GROUP BY bin ORDER BY bin ASC"
+              << " LIMIT " << Histogram::kMaxServerBins + 1;
+
+        if (mysql_query(conn, query.str().c_str())) {
+            std::cerr << "Query failed: " << mysql_error(conn)
+                      << "\nQuery: " << query.str() << std::endl;
+            return bins;
+        }
+
+        MYSQL_RES* res = mysql_store_result(conn);
+        if (!res) {
+            std::cerr << "Failed to retrieve result: " << mysql_error(conn) << std::endl;
+            return bins;
+        }
+
+        bins.reserve(mysql_num_rows(res));
+        MYSQL_ROW row;
+        while ((row = mysql_fetch_row(res))) {
+            if (!row[0] || !row[1]) continue;
+            try {
+                bins.emplace_back(std::stoll(row[0]), std::stoull(row[1]));
+            } catch (const std::exception& e) {
+                std::cerr << "Invalid data format encountered: " << e.what() << ". Skipping row." << std::endl;
+            }
+        }
+
+        mysql_free_result(res);
+    } catch (const std::exception& e) {
+        std::cerr << "Unexpected error in fetchServerHistogram: " << e.what() << std::endl;
+    }
+
+    return bins;
+}
+
+bool DataHandler::fetchWindowStart(int windowMinutes, std::string& windowStart) {
+    MYSQL* conn = dbConnector->getConnection();
+    if (!conn) {
+        std::cerr << "Database connection is null." << std::endl;
+        return false;
+    }
+
+    // Resolved once so every field's window ends at the same newest row
+    std::ostringstream query;
+    query << "SELECT MAX(timestamp) - INTERVAL " << windowMinutes << " MINUTE FROM laser_data";
+    if (mysql_query(conn, query.str().c_str())) {
+        std::cerr << "Query failed: " << mysql_error(conn) << "\nQuery: " << query.str() << std::endl;
+        return false;
+    }
+
+    MYSQL_RES* res = mysql_store_result(conn);
+    if (!res) {
+        std::cerr << "Failed to retrieve result: " << mysql_error(conn) << std::endl;
+        return false;
+    }
+
+    // MAX() is NULL on an empty table
+    MYSQL_ROW row = mysql_fetch_row(res);
+    bool found = row && row[0];
+    if (found) windowStart = row[0];
+    mysql_free_result(res);
+    return found;
+}
+
+Correlation::Series DataHandler::fetchSeries(const std::string& field, const std::string& windowStart,
+                                             std::pmr::memory_resource* arena) {
+    Correlation::Series series;
+    series.name = field;
+
+    // Timestamps are already integers after decoding, so alignment never compares strings
+    SampleSeries rawData = fetchField(field, buildWindowQuery(field, windowStart, kCorrelationRowLimit), arena);
+    // The window query returns newest first; alignment needs ascending time
+    std::reverse(rawData.begin(), rawData.end());
+    series.times.reserve(rawData.size());
+    series.values.reserve(rawData.size());
+    for (const auto& entry : rawData) {
+        series.times.push_back(entry.timestamp);
+        series.values.push_back(entry.value);
+    }
+
+    return series;
+}
+
+void DataHandler::correlateFields() {
+    printTableHeaders();
+
+    std::cout << "\nEnter two or more field names to correlate, separated by spaces: ";
+    std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+    std::string line;
+    std::getline(std::cin, line);
+
+    std::vector<std::string> fields;
+    std::istringstream fieldStream(line);
+    std::string fieldName;
+    while (fieldStream >> fieldName) {
+        FieldDescriptor field;
+        if (!findField(fieldName, field)) {
+            std::cout << "Unknown field: " << fieldName << std::endl;
+            return;
+        }
+        fields.push_back(field.name);
+    }
+    if (fields.size() < 2) {
+        std::cout << "At least two fields are required." << std::endl;
+        return;
+    }
+
+    int alignChoice;
+    std::cout << "\nChoose an alignment mode:\n";
+    std::cout << "1. Nearest sample within a tolerance\n";
+    std::cout << "2. Resample to a fixed time grid\n";
+    std::cout << "Please select an option: ";
+    std::cin >> alignChoice;
+    if (alignChoice != 1 && alignChoice != 2) {
+        std::cout << "Invalid choice." << std::endl;
+        return;
+    }
+
+    double windowMs;
+    std::cout << (alignChoice == 1 ? "Enter the tolerance in milliseconds: "
+                                   : "Enter the grid step in milliseconds: ");
+    if (!(std::cin >> windowMs) || windowMs < 0) {
+        std::cin.clear();
+        std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+        std::cout << "Invalid time window." << std::endl;
+        return;
+    }
+    int maxLag;
+    std::cout << "Enter the maximum lag to test, in aligned samples (0 to skip): ";
+    if (!(std::cin >> maxLag) || maxLag < 0) {
+        std::cin.clear();
+        std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+        std::cout << "Invalid lag." << std::endl;
+        return;
+    }
+    int windowMinutes;
+    std::cout << "Enter how many minutes of data to use, ending at the newest row (0 for the latest "
+              << kCorrelationRowLimit << " rows): ";
+    if (!(std::cin >> windowMinutes) || windowMinutes < 0) {
+        std::cin.clear();
+        std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+        std::cout << "Invalid time range." << std::endl;
+        return;
+    }
+    std::string windowStart;
+    if (windowMinutes > 0 && !fetchWindowStart(windowMinutes, windowStart)) {
+        std::cout << "No data found in laser_data." << std::endl;
+        return;
+    }
+
+    std::vector<Correlation::Series> series;
+    {
+        // Raw rows for every field share one arena, released at the end of this block,
+        // before alignment; the series themselves own plain vectors
+        std::pmr::monotonic_buffer_resource arena(kArenaInitialBytes);
+        for (const auto& name : fields) {
+            series.push_back(fetchSeries(name, windowStart, &arena));
+            if (series.back().times.empty()) {
+                std::cout << "No data found for field " << name << "." << std::endl;
+                return;
+            }
+        }
+    }
+
+    try {
+        int64_t windowMicros = static_cast<int64_t>(windowMs * 1000.0);
+        Correlation::AlignedSeries aligned = alignChoice == 1
+            ? Correlation::alignWithTolerance(series, windowMicros)
+            : Correlation::resampleToGrid(series, windowMicros);
+
+        if (aligned.times.size() < 2) {
+            std::cout << "Too few aligned samples to correlate. Try a wider window." << std::endl;
+            return;
+        }
+        printCorrelations(aligned, maxLag);
+    } catch (const std::exception& e) {
+        std::cerr << "Correlation failed: " << e.what() << std::endl;
+    }
+}
+
+void DataHandler::printCorrelations(const Correlation::AlignedSeries& aligned, int maxLag) {
+    const auto& names = aligned.names;
+    std::cout << "\nAligned samples: " << aligned.times.size() << "\n";
+
+    std::cout << "\nPairwise correlation:\n";
+    for (size_t a = 0; a < names.size(); ++a) {
+        for (size_t b = a + 1; b < names.size(); ++b) {
+            std::cout << names[a] << " vs " << names[b]
+                      << ": Pearson " << Correlation::pearson(aligned.columns[a], aligned.columns[b])
+                      << ", Spearman " << Correlation::spearman(aligned.columns[a], aligned.columns[b])
+                      << "\n";
+        }
+    }
+
+    std::cout << "\nCovariance matrix:\n" << std::setw(16) << "";
+    for (const auto& name : names) {
+        std::cout << std::setw(16) << name;
+    }
+    std::cout << "\n";
+    auto covariance = Correlation::covarianceMatrix(aligned);
+    for (size_t a = 0; a < names.size(); ++a) {
+        std::cout << std::setw(16) << names[a];
+        for (size_t b = 0; b < names.size(); ++b) {
+            std::cout << std::setw(16) << covariance[a][b];
+        }
+        std::cout << "\n";
+    }
+    std::cout << std::flush;
+
+    if (maxLag == 0) return;
+
+    // Lagged cross-correlation of the first field against each of the others
+    for (size_t b = 1; b < names.size(); ++b) {
+        auto lags = Correlation::crossCorrelation(aligned.columns[0], aligned.columns[b], maxLag);
+
+        int bestLag = 0;
+        double bestValue = 0.0;
+        for (size_t i = 0; i < lags.size(); ++i) {
+            if (std::isfinite(lags[i]) && std::abs(lags[i]) > std::abs(bestValue)) {
+                bestValue = lags[i];
+                bestLag = static_cast<int>(i) - maxLag;
+            }
+        }
+
+        std::cout << "\nCross-correlation " << names[0] << " vs " << names[b]
+                  << " (positive lag: " << names[b] << " follows " << names[0] << ")\n";
+        std::cout << "Strongest at lag " << bestLag << ": " << bestValue << std::endl;
+    }
+}
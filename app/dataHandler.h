@@ -1,48 +1,86 @@
 #ifndef DATA_HANDLER_H
 #define DATA_HANDLER_H
 
+#include "correlation.h"
 #include "databaseConnector.h"
+#include "histogram.h"
+#include "laserDataFields.h"
+#include "schemaCache.h"
+#include <cstdint>
+#include <memory_resource>
 #include <string>
 #include <vector>
-#include <chrono>
+
+// One decoded row: microseconds since the epoch and the field value in display units
+struct Sample {
+    int64_t timestamp;
+    double value;
+};
+
+// Rows are allocated from a per-analysis arena rather than the global heap
+typedef std::pmr::vector<Sample> SampleSeries;
 
 class DataHandler {
 public:
-    DataHandler(DatabaseConnector* dbConnector);
+    DataHandler(DatabaseConnector* dbConnector, SchemaCache* schemaCache);
 
     // Graph data generation methods
     void generateData();
     void analyzeField();
+    void correlateFields();
 
     void chooseGraphData();
     static std::string lastGraphType;
 
+    // SQL the handler generates for a field, and every query it issues for graphing
+    static std::string buildFieldQuery(const std::string& field);
+    // Most recent rowLimit values at or after windowStart (empty for no window), newest first
+    static std::string buildWindowQuery(const std::string& field, const std::string& windowStart,
+                                        size_t rowLimit);
+    static std::vector<std::string> generatedQueries();
+
+    // Look up a user-chosen field in the laser_data registry
+    static bool findField(const std::string& name, FieldDescriptor& descriptor);
+
 private:
     // Data preprocessing and timestamp parsing
-    std::vector<std::pair<double, double>> preprocessData(
-        const std::vector<std::pair<std::string, double>>& rawData);
+    std::pmr::vector<std::pair<double, double>> preprocessData(const SampleSeries& rawData);
 
-    std::chrono::system_clock::time_point parseTimestamp(const std::string& timestampStr);
+    static bool parseTimestamp(const char* text, int64_t& micros);
 
    
     void printTableHeaders();
     
     
-    // Fetch data for graphing
-    std::vector<std::pair<std::string, double>> fetchPowerData();
-    std::vector<std::pair<std::string, double>> fetchFlowRateData();
-    std::vector<std::pair<std::string, double>> fetchFrequencyData();
-
-    void calculateRange(const std::vector<double>& values);
-    void calculateMean(const std::vector<double>& values);
-    void calculateMedian(std::vector<double>& values);
-    void calculateStandardDeviation(const std::vector<double>& values);
-    void identifyOutliers(const std::vector<double>& values);
+    // Run a query from buildFieldQuery/buildWindowQuery, converted to the field's display unit
+    SampleSeries fetchField(const std::string& name, const std::string& query,
+                            std::pmr::memory_resource* arena);
+
+    void calculateRange(const std::pmr::vector<double>& values);
+    void calculateMean(const std::pmr::vector<double>& values);
+    void calculateMedian(std::pmr::vector<double>& values);
+    void calculateStandardDeviation(const std::pmr::vector<double>& values);
+    void identifyOutliers(const std::pmr::vector<double>& values);
+
+    // Distribution of the fetched values, and of the whole table via server-side binning
+    void showHistogram(const std::pmr::vector<double>& values);
+    void showServerHistogram(const FieldDescriptor& field);
+    std::vector<std::pair<long long, uint64_t>> fetchServerHistogram(const FieldDescriptor& field, double width);
+
+    // Start of a window ending at the newest row, as a server DATETIME string
+    bool fetchWindowStart(int windowMinutes, std::string& windowStart);
+    // Field values keyed by timestamp in microseconds, for time alignment
+    Correlation::Series fetchSeries(const std::string& field, const std::string& windowStart,
+                                    std::pmr::memory_resource* arena);
+    void printCorrelations(const Correlation::AlignedSeries& aligned, int maxLag);
     
-    std::vector<std::pair<std::string, double>> fetchDataFromDatabase(const std::string& query);
+    // Typed decode path generated per registry field
+    template <typename Field>
+    SampleSeries fetchDataFromDatabase(const std::string& query, std::pmr::memory_resource* arena);
 
     // Pointer to database connector
     DatabaseConnector* dbConnector;
+    SchemaCache* schemaCache; // Shared table metadata, may be null
 };
 
 #endif // DATA_HANDLER_H
\ No newline at end of file
@@ -5,9 +5,23 @@
 #include <limits>
 #include <sstream>
 
-DatabaseApp::DatabaseApp(DatabaseConnector* dbConnector)
+namespace {
+    // Client-side result cache limits for ad-hoc queries
+    const size_t kQueryCacheBytes = 64 * 1024 * 1024;
+    const std::chrono::seconds kQueryCacheTtl(300);
+
+    // Where the advisor remembers which query shapes were index-served
+    const char* kPlanBaselineFile = "query_plans.txt";
+}
+
+DatabaseApp::DatabaseApp(DatabaseConnector* dbConnector, SchemaCache* schemaCache)
     : dbConnector(dbConnector), 
-      dataHandler(new DataHandler(dbConnector)), // Initialize DataHandler
+      schemaCache(schemaCache),
+      dataHandler(new DataHandler(dbConnector, schemaCache)), // Initialize DataHandler
+      queryCache(kQueryCacheBytes, kQueryCacheTtl),
+      cacheScope(dbConnector ? dbConnector->getUser() + "@" + dbConnector->getHost() + "/" +
+                               dbConnector->getDatabase() + "\n" : ""),
+      queryAdvisor(dbConnector, kPlanBaselineFile),
       storageThreshold(80), 
       dataRemovalAmount(30) {}
 
@@ -18,11 +32,16 @@ void DatabaseApp::displayMenu() {
     std::cout << "1. Run Query\n";
     std::cout << "2. Configure Program\n";
     std::cout << "3. Mathmatical Operations\n";
-    std::cout << "4. Exit\n";
+    std::cout << "4. Query Advisor\n";
+    std::cout << "5. Query Cache Statistics\n";
+    std::cout << "6. Exit\n";
     std::cout << "Please select an option: ";
 }
 
 void DatabaseApp::run() {
+    // Catch plans that regressed since the last run, e.g. after a schema change made elsewhere
+    checkPlanRegressions();
+
     int choice;
     do {
         // Clear any previous error flags and input buffer
@@ -51,19 +70,44 @@ void DatabaseApp::run() {
                 analyseData();
                 break;
             case 4:
+                queryAdvisorMenu();
+                break;
+            case 5:
+                showCacheStatistics();
+                break;
+            case 6:
                 std::cout << "Exiting the program..." << std::endl;
                 break;
             default:
-                std::cout << "Invalid choice. Please select a valid option (0-4)." << std::endl;
+                std::cout << "Invalid choice. Please select a valid option (0-6)." << std::endl;
         }
-    } while (choice != 4);
+    } while (choice != 6);
 }
 
 void DatabaseApp::analyseData() {
-    if (dataHandler) {
-        dataHandler->analyzeField();
-    } else {
+    if (!dataHandler) {
         std::cerr << "Data handler not initialized." << std::endl;
+        return;
+    }
+
+    int analysisType;
+    std::cout << "\n1. Single Field Analysis\n";
+    std::cout << "2. Cross-field Correlation\n";
+    std::cout << "Please select an option: ";
+    if (!(std::cin >> analysisType)) {
+        std::cout << "Invalid input. Please enter a number." << std::endl;
+        return;
+    }
+
+    switch (analysisType) {
+        case 1:
+            dataHandler->analyzeField();
+            break;
+        case 2:
+            dataHandler->correlateFields();
+            break;
+        default:
+            std::cout << "Invalid choice." << std::endl;
     }
 }
 
@@ -84,48 +128,157 @@ void DatabaseApp::executeQuery(const std::string& query) {
         return;
     }
 
+    lastQuery = query;
+    std::string normalised = QueryCache::normalise(query);
+    std::string cacheKey = cacheScope + normalised;
+    bool cacheable = QueryCache::isCacheable(normalised);
+
+    if (cacheable) {
+        const QueryCache::Result* cached = queryCache.lookup(cacheKey);
+        if (cached) {
+            printQueryResult(*cached);
+            std::cout << "(served from cache)" << std::endl;
+            return;
+        }
+    } else {
+        queryCache.recordBypass();
+    }
+
     try {
         MYSQL* conn = dbConnector->getConnection();
         if (mysql_query(conn, query.c_str())) {
             throw std::runtime_error(mysql_error(conn));
         }
 
+        // Anything this statement may have written is now stale
+        queryCache.invalidateFor(normalised);
+        if (schemaCache && SchemaCache::isSchemaChange(normalised)) {
+            schemaCache->invalidate();
+            schemaCache->refreshAsync(dbConnector);
+        }
+
         MYSQL_RES* res = mysql_store_result(conn);
         if (!res) {
             // Check if the query was a non-SELECT query (INSERT, UPDATE, DELETE)
             if (mysql_field_count(conn) == 0) {
                 std::cout << "Query executed successfully. Rows affected: " 
                           << mysql_affected_rows(conn) << std::endl;
+                // A dropped or altered index shows up here rather than on a dashboard later
+                if (SchemaCache::isSchemaChange(normalised)) {
+                    checkPlanRegressions();
+                }
                 return;
             }
             throw std::runtime_error(mysql_error(conn));
         }
 
-        // Print query results
+        QueryCache::Result result;
         int num_fields = mysql_num_fields(res);
         MYSQL_FIELD* fields = mysql_fetch_fields(res);
 
-        // Print column headers
         for (int i = 0; i < num_fields; ++i) {
-            std::cout << fields[i].name << "\t";
+            result.columns.emplace_back(fields[i].name);
         }
-        std::cout << std::endl;
 
-        // Print rows of data
+        result.rows.reserve(mysql_num_rows(res));
         MYSQL_ROW row;
         while ((row = mysql_fetch_row(res))) {
+            std::vector<std::string> values;
+            values.reserve(num_fields);
             for (int i = 0; i < num_fields; ++i) {
-                std::cout << (row[i] ? row[i] : "NULL") << "\t";
+                values.emplace_back(row[i] ? row[i] : "NULL");
             }
-            std::cout << std::endl;
+            result.rows.push_back(std::move(values));
         }
 
         mysql_free_result(res);  // Free the result set
+
+        printQueryResult(result);
+        if (cacheable) {
+            queryCache.store(cacheKey, normalised, std::move(result));
+        }
     } catch (const std::exception& e) {
         std::cerr << "Query Error: " << e.what() << std::endl;
     }
 }
 
+void DatabaseApp::printQueryResult(const QueryCache::Result& result) {
+    // Print column headers
+    for (const auto& column : result.columns) {
+        std::cout << column << "\t";
+    }
+    std::cout << std::endl;
+
+    // Print rows of data
+    for (const auto& row : result.rows) {
+        for (const auto& value : row) {
+            std::cout << value << "\t";
+        }
+        std::cout << std::endl;
+    }
+}
+
+void DatabaseApp::showCacheStatistics() {
+    const QueryCache::Stats& stats = queryCache.getStats();
+    uint64_t lookups = stats.hits + stats.misses;
+
+    std::cout << "\n===== Query Cache Statistics =====\n";
+    std::cout << "Hits: " << stats.hits << "\n";
+    std::cout << "Misses: " << stats.misses << "\n";
+    std::cout << "Hit Rate: " << (lookups ? 100.0 * stats.hits / lookups : 0.0) << "%\n";
+    std::cout << "Bypassed (non-SELECT or non-deterministic): " << stats.bypasses << "\n";
+    std::cout << "Evictions: " << stats.evictions << "\n";
+    std::cout << "Invalidations: " << stats.invalidations << "\n";
+    std::cout << "Entries: " << stats.entries << "\n";
+    std::cout << "Memory Used: " << stats.bytes / 1024 << " KiB of "
+              << kQueryCacheBytes / 1024 << " KiB" << std::endl;
+}
+
+void DatabaseApp::queryAdvisorMenu() {
+    std::cout << "\n===== Query Advisor =====\n";
+    std::cout << "1. Check Application Queries\n";
+    std::cout << "2. Explain a Query\n";
+    std::cout << "3. Analyze a Query (executes it)\n";
+    std::cout << "4. Return to Previous Menu\n";
+    std::cout << "Please select an option: ";
+
+    int advisorChoice;
+    if (!(std::cin >> advisorChoice)) {
+        std::cout << "Invalid input. Please enter a number." << std::endl;
+        return;
+    }
+
+    switch (advisorChoice) {
+        case 1:
+            queryAdvisor.offerIndexes(queryAdvisor.reviewAll(DataHandler::generatedQueries(), true));
+            break;
+        case 2:
+        case 3: {
+            std::string query;
+            std::cout << "\nEnter SQL Query (leave empty to use the last query run): ";
+            std::cin.ignore();  // To clear the input buffer
+            std::getline(std::cin, query);
+            if (query.empty()) query = lastQuery;
+
+            if (query.empty()) {
+                std::cout << "No query to analyse." << std::endl;
+                break;
+            }
+            queryAdvisor.review(query, advisorChoice == 3);
+            break;
+        }
+        case 4:
+            return;
+        default:
+            std::cout << "Invalid option. Please select a valid option (1-4)." << std::endl;
+    }
+}
+
+void DatabaseApp::checkPlanRegressions() {
+    // Non-interactive: only regressions against the stored baseline are printed
+    queryAdvisor.reviewAll(DataHandler::generatedQueries(), false);
+}
+
 void DatabaseApp::configureProgram() {
     // Fetch the current values of the settings from the database
     int currentStorageThreshold;
@@ -270,6 +423,7 @@ void DatabaseApp::updateDatabaseSetting(const std::string& settingName, int valu
     }
 
     std::cout << settingName << " successfully updated in the database." << std::endl;
+    queryCache.invalidateTable("settings");
     
     // Close the admin connection
     mysql_close(conn);
@@ -3,13 +3,16 @@
 
 #include "databaseConnector.h"
 #include "dataHandler.h"
+#include "queryAdvisor.h"
+#include "queryCache.h"
+#include "schemaCache.h"
 #include <string>
 #include <vector>
 #include <chrono>
 
 class DatabaseApp {
 public:
-    DatabaseApp(DatabaseConnector* dbConnector);
+    DatabaseApp(DatabaseConnector* dbConnector, SchemaCache* schemaCache);
      ~DatabaseApp();
     void run();
 
@@ -17,6 +20,10 @@ private:
     void displayMenu();
     void runQueryMenu();
     void executeQuery(const std::string& query);
+    void printQueryResult(const QueryCache::Result& result);
+    void showCacheStatistics();
+    void queryAdvisorMenu();
+    void checkPlanRegressions();
     void configureProgram();
     void analyseData(); // Add this method declaration
     void calculateStatistics();
@@ -29,7 +36,12 @@ private:
     void setDataRemovalAmount();
 
     DatabaseConnector* dbConnector;
+    SchemaCache* schemaCache;
     DataHandler* dataHandler; // Add a DataHandler pointer
+    QueryCache queryCache;
+    std::string cacheScope; // Prefix that keeps cache keys distinct per connection/database
+    QueryAdvisor queryAdvisor;
+    std::string lastQuery; // Most recent ad-hoc query, offered to the advisor
     int storageThreshold;
     int dataRemovalAmount;
 };
@@ -3,7 +3,7 @@
 
 DatabaseConnector::DatabaseConnector(const std::string& host, const std::string& user,
                                      const std::string& pass, const std::string& db)
-    : conn(mysql_init(nullptr)) {
+    : conn(mysql_init(nullptr)), host(host), user(user), pass(pass), database(db) {
     if (!conn) {
         throw std::runtime_error("mysql_init() failed");
     }
@@ -26,4 +26,33 @@ DatabaseConnector::~DatabaseConnector() {
 
 MYSQL* DatabaseConnector::getConnection() { 
     return conn; 
+}
+
+MYSQL* DatabaseConnector::openConnection() const {
+    MYSQL* extra = mysql_init(nullptr);
+    if (!extra) {
+        throw std::runtime_error("mysql_init() failed");
+    }
+
+    if (!mysql_real_connect(extra, host.c_str(), user.c_str(), pass.c_str(),
+                            database.c_str(), 0, nullptr, 0)) {
+        std::string error_msg = "mysql_real_connect() failed: " + 
+                                std::string(mysql_error(extra));
+        mysql_close(extra);
+        throw std::runtime_error(error_msg);
+    }
+
+    return extra;
+}
+
+const std::string& DatabaseConnector::getHost() const {
+    return host;
+}
+
+const std::string& DatabaseConnector::getUser() const {
+    return user;
+}
+
+const std::string& DatabaseConnector::getDatabase() const {
+    return database;
 }
\ No newline at end of file
@@ -12,8 +12,20 @@ public:
 
     MYSQL* getConnection();
 
+    // Open an additional connection with the same credentials; the caller closes it
+    MYSQL* openConnection() const;
+
+    // Connection identity, used to scope client-side caches
+    const std::string& getHost() const;
+    const std::string& getUser() const;
+    const std::string& getDatabase() const;
+
 private:
     MYSQL* conn;
+    std::string host;
+    std::string user;
+    std::string pass;
+    std::string database;
     // Prevent copying
     DatabaseConnector(const DatabaseConnector&) = delete;
     DatabaseConnector& operator=(const DatabaseConnector&) = delete;
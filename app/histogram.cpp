@@ -0,0 +1,251 @@
+#include "histogram.h"
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+namespace {
+    // Values are binned in blocks so the index computation is a tight, branch-free
+    // loop the compiler can vectorise; the scatter into counts happens afterwards.
+    const size_t kBlockSize = 256;
+
+    // Below this size spinning up worker threads costs more than it saves
+    const size_t kParallelThreshold = 1 << 18;
+
+    // Maximum number of values sorted to place quantile edges
+    const size_t kQuantileSampleSize = 1 << 16;
+}
+
+Histogram::Histogram(BinMode mode, size_t binCount)
+    : mode(mode), requestedBins(binCount), binCount(binCount), skipped(0),
+      origin(0.0), scale(0.0), limit(0.0) {
+    if (binCount == 0) {
+        throw std::invalid_argument("Histogram requires at least one bin");
+    }
+}
+
+bool Histogram::computeEdges(const double* values, size_t count) {
+    binCount = requestedBins;
+    edges.assign(binCount + 1, 0.0);
+
+    if (mode == BinMode::Quantile) {
+        // Large inputs are subsampled with an even stride: the edges become approximate
+        // quantiles, but the counts below are still exact
+        size_t stride = std::max<size_t>(1, count / kQuantileSampleSize);
+        std::vector<double> sorted;
+        sorted.reserve(count / stride + 1);
+        for (size_t i = 0; i < count; i += stride) {
+            if (std::isfinite(values[i])) sorted.push_back(values[i]);
+        }
+        if (sorted.empty()) return false;
+
+        std::sort(sorted.begin(), sorted.end());
+        size_t last = sorted.size() - 1;
+        for (size_t i = 0; i <= binCount; ++i) {
+            edges[i] = sorted[i * last / binCount];
+        }
+
+        // The outer edges must cover every value, including ones the sample skipped
+        for (size_t i = 0; i < count; ++i) {
+            double value = values[i];
+            if (!std::isfinite(value)) continue;
+            edges.front() = std::min(edges.front(), value);
+            edges.back() = std::max(edges.back(), value);
+        }
+
+        // Repeated values put several quantiles on the same edge; merge them so no bin is
+        // zero-width. A constant input keeps one unit-wide bin, as in fixed-width mode.
+        edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+        if (edges.size() == 1) edges.push_back(edges.front() + 1.0);
+        binCount = edges.size() - 1;
+        return true;
+    }
+
+    double minValue = std::numeric_limits<double>::infinity();
+    double maxValue = -std::numeric_limits<double>::infinity();
+    for (size_t i = 0; i < count; ++i) {
+        double value = values[i];
+        // Log bins can only hold positive values
+        if (!std::isfinite(value) || (mode == BinMode::LogScale && value <= 0.0)) continue;
+        minValue = std::min(minValue, value);
+        maxValue = std::max(maxValue, value);
+    }
+    if (minValue > maxValue) return false;
+
+    if (mode == BinMode::LogScale) {
+        double logMin = std::log10(minValue);
+        double logMax = std::log10(maxValue);
+        if (logMax == logMin) logMax = logMin + 1.0;
+
+        origin = logMin;
+        limit = logMax;
+        scale = binCount / (logMax - logMin);
+        for (size_t i = 0; i <= binCount; ++i) {
+            edges[i] = std::pow(10.0, logMin + i / scale);
+        }
+    } else {
+        if (maxValue == minValue) maxValue = minValue + 1.0;
+
+        origin = minValue;
+        limit = maxValue;
+        scale = binCount / (maxValue - minValue);
+        for (size_t i = 0; i <= binCount; ++i) {
+            edges[i] = minValue + i / scale;
+        }
+    }
+    return true;
+}
+
+void Histogram::countRange(const double* values, size_t count, std::vector<uint64_t>& partial,
+                           uint64_t& partialSkipped) const {
+    // Slot binCount collects values that do not belong to any bin
+    std::vector<uint64_t> slots(binCount + 1, 0);
+    uint32_t indices[kBlockSize];
+    const double upper = static_cast<double>(binCount);
+    const uint32_t lastBin = static_cast<uint32_t>(binCount - 1);
+
+    for (size_t start = 0; start < count; start += kBlockSize) {
+        size_t blockSize = std::min(kBlockSize, count - start);
+        const double* block = values + start;
+
+        if (mode == BinMode::Quantile) {
+            // Edges are data dependent, so fall back to a binary search per value
+            for (size_t i = 0; i < blockSize; ++i) {
+                double x = block[i];
+                bool inRange = x >= edges.front() && x <= edges.back();
+                size_t bin = std::upper_bound(edges.begin() + 1, edges.end() - 1, x) - (edges.begin() + 1);
+                indices[i] = inRange ? static_cast<uint32_t>(bin) : static_cast<uint32_t>(binCount);
+            }
+        } else {
+            const bool logScale = mode == BinMode::LogScale;
+            for (size_t i = 0; i < blockSize; ++i) {
+                double x = logScale ? std::log10(block[i]) : block[i];
+                double pos = (x - origin) * scale;
+
+                // Range is decided on x itself: (limit - origin) * scale can round to just
+                // above binCount. NaN fails both comparisons and goes to the overflow slot.
+                bool inRange = x >= origin && x <= limit;
+                double safePos = inRange ? std::min(std::max(pos, 0.0), upper) : upper;
+                uint32_t bin = static_cast<uint32_t>(safePos);
+                indices[i] = inRange ? std::min(bin, lastBin) : static_cast<uint32_t>(binCount);
+            }
+        }
+
+        for (size_t i = 0; i < blockSize; ++i) {
+            ++slots[indices[i]];
+        }
+    }
+
+    for (size_t i = 0; i < binCount; ++i) {
+        partial[i] += slots[i];
+    }
+    partialSkipped += slots[binCount];
+}
+
+void Histogram::build(const double* values, size_t count) {
+    skipped = 0;
+
+    if (!computeEdges(values, count)) {
+        counts.assign(binCount, 0);
+        skipped = count;
+        return;
+    }
+
+    // Quantile edges may have merged, so size the counts after placing them
+    counts.assign(binCount, 0);
+
+    unsigned threadCount = std::thread::hardware_concurrency();
+    if (count < kParallelThreshold || threadCount < 2) {
+        countRange(values, count, counts, skipped);
+        return;
+    }
+
+    // Each thread fills its own partial histogram; they are merged once all have finished
+    std::vector<std::vector<uint64_t>> partials(threadCount, std::vector<uint64_t>(binCount, 0));
+    std::vector<uint64_t> partialSkipped(threadCount, 0);
+    std::vector<std::thread> workers;
+    size_t chunk = (count + threadCount - 1) / threadCount;
+
+    for (unsigned t = 0; t < threadCount; ++t) {
+        size_t begin = t * chunk;
+        if (begin >= count) break;
+        size_t end = std::min(count, begin + chunk);
+        workers.emplace_back([this, values, &partials, &partialSkipped, t, begin, end]() {
+            countRange(values + begin, end - begin, partials[t], partialSkipped[t]);
+        });
+    }
+
+    for (auto& worker : workers) {
+        worker.join();
+    }
+
+    for (unsigned t = 0; t < threadCount; ++t) {
+        for (size_t i = 0; i < binCount; ++i) {
+            counts[i] += partials[t][i];
+        }
+        skipped += partialSkipped[t];
+    }
+}
+
+bool Histogram::loadServerBins(const std::vector<std::pair<long long, uint64_t>>& bins, double width) {
+    counts.clear();
+    edges.clear();
+    skipped = 0;
+    if (bins.empty() || width <= 0.0) return false;
+
+    // Bins arrive sorted by index; empty bins in between are not returned by the server,
+    // so a sparse result can still span far more bins than it contains
+    long long firstBin = bins.front().first;
+    long long lastBin = bins.back().first;
+    if (lastBin < firstBin || static_cast<unsigned long long>(lastBin - firstBin) >= kMaxServerBins) {
+        return false;
+    }
+    binCount = static_cast<size_t>(lastBin - firstBin + 1);
+
+    counts.assign(binCount, 0);
+    edges.resize(binCount + 1);
+    for (size_t i = 0; i <= binCount; ++i) {
+        edges[i] = (firstBin + static_cast<long long>(i)) * width;
+    }
+    for (const auto& bin : bins) {
+        counts[static_cast<size_t>(bin.first - firstBin)] += bin.second;
+    }
+
+    mode = BinMode::FixedWidth;
+    origin = edges.front();
+    limit = edges.back();
+    scale = 1.0 / width;
+    return true;
+}
+
+void Histogram::print(std::ostream& out, size_t barWidth) const {
+    if (counts.empty()) {
+        out << "Histogram is empty." << std::endl;
+        return;
+    }
+
+    uint64_t maxCount = *std::max_element(counts.begin(), counts.end());
+    uint64_t total = 0;
+    for (uint64_t count : counts) total += count;
+
+    std::ios::fmtflags flags = out.flags();
+    std::streamsize precision = out.precision();
+    out << std::setprecision(4);
+
+    for (size_t i = 0; i < counts.size(); ++i) {
+        size_t barLength = maxCount ? static_cast<size_t>(counts[i] * barWidth / maxCount) : 0;
+        out << "[" << std::setw(10) << edges[i] << ", " << std::setw(10) << edges[i + 1]
+            << (i + 1 == counts.size() ? "] " : ") ")
+            << std::setw(10) << counts[i] << " | " << std::string(barLength, '#') << "\n";
+    }
+
+    out << "Total: " << total;
+    if (skipped) out << " (" << skipped << " values outside the bins)";
+    out << std::endl;
+
+    out.flags(flags);
+    out.precision(precision);
+}
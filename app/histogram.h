@@ -0,0 +1,58 @@
+#ifndef HISTOGRAM_H
+#define HISTOGRAM_H
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <utility>
+#include <vector>
+
+class Histogram {
+public:
+    enum class BinMode {
+        FixedWidth,  // Equal-width bins between min and max
+        LogScale,    // Equal-width bins in log10 space (positive values only)
+        Quantile     // Bin edges at equally spaced quantiles
+    };
+
+    // Upper limit on server-side bins, which the caller derives from a bin width
+    static constexpr size_t kMaxServerBins = 1000;
+
+    Histogram(BinMode mode, size_t binCount);
+
+    // Compute bin edges from the data and count every value into a bin
+    void build(const double* values, size_t count);
+
+    // Load fixed-width bins produced by the server (GROUP BY FLOOR(col/w)); returns
+    // false if they span more than kMaxServerBins
+    bool loadServerBins(const std::vector<std::pair<long long, uint64_t>>& bins, double width);
+
+    // Render as a horizontal text bar chart
+    void print(std::ostream& out, size_t barWidth = 50) const;
+
+    const std::vector<double>& getEdges() const { return edges; }
+    const std::vector<uint64_t>& getCounts() const { return counts; }
+    uint64_t getSkipped() const { return skipped; }
+
+private:
+    // Bin edge computation for each mode
+    bool computeEdges(const double* values, size_t count);
+
+    // Count the first count values into a partial histogram
+    void countRange(const double* values, size_t count, std::vector<uint64_t>& partial,
+                    uint64_t& partialSkipped) const;
+
+    BinMode mode;
+    size_t requestedBins;          // Bins asked for; quantile mode may merge some away
+    size_t binCount;
+    std::vector<double> edges;     // binCount + 1 edges
+    std::vector<uint64_t> counts;  // binCount counts
+    uint64_t skipped;              // Values that fell outside every bin (NaN, <= 0 for log)
+
+    // Fixed-width/log mapping: index = (x - origin) * scale
+    double origin;
+    double scale;
+    double limit;  // Largest x that belongs to the last bin (max value, or its log10)
+};
+
+#endif // HISTOGRAM_H
@@ -0,0 +1,80 @@
+#ifndef LASER_DATA_FIELDS_H
+#define LASER_DATA_FIELDS_H
+
+#include <cstdlib>
+#include <string>
+#include <strings.h>
+#include <utility>
+#include <vector>
+
+// Static description of a laser_data column
+struct FieldDescriptor {
+    const char* name;      // Column name in laser_data
+    const char* sqlType;   // Declared SQL type
+    const char* unit;      // Unit of the value after scaling
+    double scale;          // Multiplier from the stored value to the display unit
+    bool nullable;
+};
+
+// One type per measurement column. Descriptors are constexpr so the decode
+// kernels below fold each field's scale into the fetch loop at compile time.
+struct PowerReading {
+    static constexpr FieldDescriptor descriptor() { return {"powerReading", "DOUBLE", "W", 1.0 / 1000.0, true}; }
+};
+
+struct FlowRate {
+    static constexpr FieldDescriptor descriptor() { return {"flowRate", "DOUBLE", "L", 1.0 / 1000.0, true}; }
+};
+
+struct Frequency {
+    static constexpr FieldDescriptor descriptor() { return {"frequency", "DOUBLE", "Hz", 1.0, true}; }
+};
+
+template <typename... Fields>
+struct FieldList {
+    static std::vector<FieldDescriptor> descriptors() {
+        return {Fields::descriptor()...};
+    }
+};
+
+// Every column DataHandler may read; add new fields here
+using LaserDataFields = FieldList<PowerReading, FlowRate, Frequency>;
+
+// Parse a column value and convert it to the field's display unit
+template <typename Field>
+inline bool decodeField(const char* text, double& value) {
+    char* end;
+    double raw = std::strtod(text, &end);
+    if (end == text) return false;
+
+    constexpr double scale = Field::descriptor().scale;
+    value = scale == 1.0 ? raw : raw * scale;
+    return true;
+}
+
+template <typename List>
+struct FieldDispatcher;
+
+template <>
+struct FieldDispatcher<FieldList<>> {
+    template <typename Fn>
+    static bool dispatch(const std::string&, Fn&&) {
+        return false;
+    }
+};
+
+// Call fn(Field()) for the field whose column name matches (case-insensitively,
+// as MySQL does); returns false if the name is not a known field
+template <typename First, typename... Rest>
+struct FieldDispatcher<FieldList<First, Rest...>> {
+    template <typename Fn>
+    static bool dispatch(const std::string& name, Fn&& fn) {
+        if (strcasecmp(name.c_str(), First::descriptor().name) == 0) {
+            fn(First());
+            return true;
+        }
+        return FieldDispatcher<FieldList<Rest...>>::dispatch(name, std::forward<Fn>(fn));
+    }
+};
+
+#endif // LASER_DATA_FIELDS_H
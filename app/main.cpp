@@ -1,19 +1,28 @@
 #include <iostream>
 #include <string>
+#include <chrono>
 #include "databaseConnector.h"
 #include "databaseApp.h"
+#include "schemaCache.h"
 
 int main(int argc, char *argv[]) {
     std::string host = "172.19.76.58";
     std::string user, pass, database = "my_database";
     bool connectionSuccessful = false;
     DatabaseConnector* dbConnector = nullptr;
+    SchemaCache* schemaCache = nullptr;
 
     // Allow multiple login attempts
     while (!connectionSuccessful) {
         // Input username and password
         std::cout << "Enter database username: ";
         std::cin >> user;
+
+        // Load this account's persisted table metadata while the password is typed
+        delete schemaCache;
+        schemaCache = new SchemaCache("schema_cache.txt", host, user, database, std::chrono::minutes(10));
+        schemaCache->loadFromDiskAsync();
+
         std::cout << "Enter database password: ";
         std::cin >> pass;
 
@@ -33,26 +42,32 @@ int main(int argc, char *argv[]) {
             
             // If user doesn't want to retry, exit the program
             if (retry != 'y' && retry != 'Y') {
+                delete schemaCache;
                 delete dbConnector;  // Clean up if allocated
                 return 1;
             }
         }
     }
 
+    // Refresh metadata from the server in the background; the menu does not wait for it
+    schemaCache->refreshAsync(dbConnector);
+
     try {
         // Create DatabaseApp with the connector
-        DatabaseApp databaseApp(dbConnector);
+        DatabaseApp databaseApp(dbConnector, schemaCache);
         
         // Run the application logic
         databaseApp.run();
 
-        // Clean up dynamically allocated connector
+        // Clean up dynamically allocated connector; the cache's refresh task uses it
+        delete schemaCache;
         delete dbConnector;
     } 
     catch (const std::exception& e) {
         std::cerr << "Application error: " << e.what() << std::endl;
         
         // Clean up dynamically allocated connector
+        delete schemaCache;
         delete dbConnector;
         return 1;
     }
@@ -0,0 +1,323 @@
+#include "queryAdvisor.h"
+#include "queryCache.h"
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <mariadb/mysql.h>
+#include <regex>
+
+namespace {
+    // MySQL/MariaDB limit on identifier length
+    const size_t kMaxIdentifierLength = 64;
+
+    // Wider indexes cost more on every insert than they save on reads
+    const size_t kMaxIndexColumns = 4;
+
+    bool findJsonString(const std::string& json, const std::string& key, std::string& value) {
+        std::regex pattern("\"" + key + "\"\\s*:\\s*\"([^\"]*)\"");
+        std::smatch match;
+        if (!std::regex_search(json, match, pattern)) return false;
+        value = match[1];
+        return true;
+    }
+
+    bool findJsonNumber(const std::string& json, const std::string& key, long long& value) {
+        std::regex pattern("\"" + key + "\"\\s*:\\s*(\\d+)");
+        std::smatch match;
+        if (!std::regex_search(json, match, pattern)) return false;
+        value = std::stoll(match[1]);
+        return true;
+    }
+
+    std::string stripBackticks(const std::string& name) {
+        std::string result;
+        for (char c : name) {
+            if (c != '`') result += c;
+        }
+        return result;
+    }
+
+    bool isIdentifier(const std::string& name) {
+        static const std::regex identifier("[A-Za-z_$][A-Za-z0-9_$]*");
+        return std::regex_match(name, identifier);
+    }
+}
+
+QueryAdvisor::QueryAdvisor(DatabaseConnector* dbConnector, const std::string& baselineFile)
+    : dbConnector(dbConnector), baselineFile(baselineFile) {
+    loadBaseline();
+}
+
+bool QueryAdvisor::explain(const std::string& query, bool execute, PlanReport& report) {
+    report = PlanReport();
+    report.query = query;
+
+    MYSQL* conn = dbConnector ? dbConnector->getConnection() : nullptr;
+    if (!conn) {
+        std::cerr << "Database connection is null." << std::endl;
+        return false;
+    }
+
+    // ANALYZE runs the statement; data-modifying statements must go through Run Query so
+    // the query cache is invalidated
+    if (execute && !QueryCache::isReadOnlySelect(QueryCache::normalise(query))) {
+        std::cout << "Only read-only SELECT statements can be analyzed, because ANALYZE executes "
+                  << "the statement. Showing the estimated plan instead." << std::endl;
+        execute = false;
+    }
+
+    // ANALYZE runs the statement and reports actual row counts alongside the plan
+    std::string explainQuery = (execute ? "ANALYZE FORMAT=JSON " : "EXPLAIN FORMAT=JSON ") + query;
+    if (mysql_query(conn, explainQuery.c_str())) {
+        std::cerr << "Query failed: " << mysql_error(conn) << "\nQuery: " << explainQuery << std::endl;
+        return false;
+    }
+
+    MYSQL_RES* res = mysql_store_result(conn);
+    if (!res) {
+        std::cerr << "Failed to retrieve result: " << mysql_error(conn) << std::endl;
+        return false;
+    }
+
+    std::string plan;
+    MYSQL_ROW row = mysql_fetch_row(res);
+    if (row && row[0]) plan = row[0];
+    mysql_free_result(res);
+
+    if (plan.empty()) {
+        std::cerr << "The server returned an empty plan." << std::endl;
+        return false;
+    }
+
+    static const std::regex fullScan("\"access_type\"\\s*:\\s*\"ALL\"");
+    report.fullScan = std::regex_search(plan, fullScan);
+    // MariaDB nests a "filesort" object, MySQL sets "using_filesort": true
+    report.filesort = plan.find("\"filesort\"") != std::string::npos ||
+                      std::regex_search(plan, std::regex("\"using_filesort\"\\s*:\\s*true"));
+    report.temporaryTable = plan.find("\"temporary_table\"") != std::string::npos ||
+                            std::regex_search(plan, std::regex("\"using_temporary_table\"\\s*:\\s*true"));
+    findJsonString(plan, "table_name", report.table);
+    findJsonString(plan, "key", report.key);
+    findJsonNumber(plan, "rows", report.rows);
+    return true;
+}
+
+void QueryAdvisor::reportPlan(const PlanReport& report) {
+    std::cout << "\nQuery: " << report.query << "\n";
+    std::cout << "  Table: " << (report.table.empty() ? "(none)" : report.table) << "\n";
+    std::cout << "  Index: " << (report.key.empty() ? "(none)" : report.key) << "\n";
+    if (report.rows >= 0) {
+        std::cout << "  Estimated rows examined: " << report.rows << "\n";
+    }
+    if (report.fullScan) std::cout << "  WARNING: full table scan\n";
+    if (report.filesort) std::cout << "  WARNING: filesort\n";
+    if (report.temporaryTable) std::cout << "  WARNING: temporary table\n";
+    if (report.indexServed() && !report.temporaryTable) std::cout << "  OK: served by an index\n";
+    std::cout << std::flush;
+}
+
+bool QueryAdvisor::isRegression(const PlanReport& report) const {
+    auto previous = baseline.find(shapeOf(report.query));
+    return previous != baseline.end() && previous->second && !report.indexServed();
+}
+
+bool QueryAdvisor::checkBaseline(const PlanReport& report) {
+    std::string shape = shapeOf(report.query);
+    auto previous = baseline.find(shape);
+    bool regressed = isRegression(report);
+
+    if (regressed) {
+        std::cout << "  REGRESSION: this query was previously served by an index "
+                  << "and now needs a full scan or filesort. Check recent schema changes." << std::endl;
+    }
+
+    if (previous == baseline.end() || previous->second != report.indexServed()) {
+        baseline[shape] = report.indexServed();
+        saveBaseline();
+    }
+    return regressed;
+}
+
+void QueryAdvisor::review(const std::string& query, bool execute) {
+    PlanReport report;
+    if (!explain(query, execute, report)) return;
+
+    reportPlan(report);
+    checkBaseline(report);
+    if (!report.indexServed()) {
+        offerIndex(query);
+    }
+}
+
+std::vector<std::string> QueryAdvisor::reviewAll(const std::vector<std::string>& queries, bool printPlans) {
+    int regressions = 0;
+    std::vector<std::string> needIndexes;
+
+    for (const auto& query : queries) {
+        PlanReport report;
+        if (!explain(query, false, report)) continue;
+
+        // A quiet pass still shows the plan of a regressed query, ahead of the warning
+        if (printPlans || isRegression(report)) reportPlan(report);
+        if (checkBaseline(report)) ++regressions;
+        if (!report.indexServed()) {
+            needIndexes.push_back(query);
+        }
+    }
+
+    if (printPlans || regressions) {
+        std::cout << "\nChecked " << queries.size() << " queries: " << needIndexes.size()
+                  << " not served by an index, " << regressions << " regressions." << std::endl;
+    }
+    return needIndexes;
+}
+
+void QueryAdvisor::offerIndexes(const std::vector<std::string>& queries) {
+    for (const auto& query : queries) {
+        offerIndex(query);
+    }
+}
+
+void QueryAdvisor::offerIndex(const std::string& query) {
+    std::string table;
+    std::vector<std::string> columns;
+    if (!suggestIndex(query, table, columns)) {
+        std::cout << "No index suggestion for: " << query << std::endl;
+        return;
+    }
+
+    std::cout << "\nSuggested covering index on " << table << " (";
+    for (size_t i = 0; i < columns.size(); ++i) {
+        std::cout << (i ? ", " : "") << columns[i];
+    }
+    std::cout << ")\nCreate it now? (y/n): ";
+
+    char confirm;
+    std::cin >> confirm;
+    std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+    if (confirm == 'y' || confirm == 'Y') {
+        createIndex(table, columns);
+    }
+}
+
+bool QueryAdvisor::createIndex(const std::string& table, const std::vector<std::string>& columns) {
+    MYSQL* conn = dbConnector ? dbConnector->getConnection() : nullptr;
+    if (!conn) {
+        std::cerr << "Database connection is null." << std::endl;
+        return false;
+    }
+
+    std::string name = "idx_" + table;
+    std::string columnList;
+    for (const auto& column : columns) {
+        name += "_" + column;
+        columnList += (columnList.empty() ? "`" : ", `") + column + "`";
+    }
+    name = name.substr(0, kMaxIdentifierLength);
+
+    std::string query = "CREATE INDEX `" + name + "` ON `" + table + "` (" + columnList + ")";
+    if (mysql_query(conn, query.c_str())) {
+        std::cerr << "Failed to create index: " << mysql_error(conn) << "\nQuery: " << query << std::endl;
+        return false;
+    }
+
+    std::cout << "Index " << name << " created." << std::endl;
+    return true;
+}
+
+bool QueryAdvisor::suggestIndex(const std::string& query, std::string& table, std::vector<std::string>& columns) {
+    static const std::regex selectPattern(
+        "^select\\s+(.+?)\\s+from\\s+([`\\w$.]+)(?:\\s+(?:as\\s+)?\\w+)?"
+        "(?:\\s+where\\s+(.+?))?"
+        "(?:\\s+group\\s+by\\s+(.+?))?"
+        "(?:\\s+order\\s+by\\s+(.+?))?"
+        "(?:\\s+limit\\s+.+)?$",
+        std::regex::icase);
+
+    std::string normalised = QueryCache::normalise(query);
+    std::smatch match;
+    if (!std::regex_match(normalised, match, selectPattern)) return false;
+
+    // Joins and subqueries are out of scope for a single-table suggestion
+    std::string selectList = match[1];
+    if (std::regex_search(normalised, std::regex("\\bjoin\\b|\\(\\s*select\\b", std::regex::icase))) return false;
+
+    table = stripBackticks(match[2]);
+    size_t dot = table.rfind('.');
+    if (dot != std::string::npos) table = table.substr(dot + 1);
+    columns.clear();
+
+    auto addColumn = [&columns](std::string column) {
+        column = stripBackticks(column);
+        if (!isIdentifier(column)) return;
+        for (const auto& existing : columns) {
+            if (std::equal(existing.begin(), existing.end(), column.begin(), column.end(),
+                           [](char a, char b) { return ::tolower(a) == ::tolower(b); })) {
+                return;
+            }
+        }
+        columns.push_back(column);
+    };
+
+    // Equality predicates first, then the sort/group key, then the rest of the select list
+    static const std::regex equality("([`\\w$]+)\\s*=\\s*");
+    std::string where = match[3];
+    for (std::sregex_iterator it(where.begin(), where.end(), equality), end; it != end; ++it) {
+        addColumn((*it)[1]);
+    }
+
+    static const std::regex listItem("\\s*([`\\w$]+)(?:\\s+(?:asc|desc))?\\s*(?:,|$)", std::regex::icase);
+    for (int group : {4, 5}) {
+        std::string list = match[group];
+        for (std::sregex_iterator it(list.begin(), list.end(), listItem), end; it != end; ++it) {
+            addColumn((*it)[1]);
+        }
+    }
+
+    // Range predicates on columns not already covered
+    static const std::regex range("([`\\w$]+)\\s*(?:<|>|<=|>=|between\\b)", std::regex::icase);
+    for (std::sregex_iterator it(where.begin(), where.end(), range), end; it != end; ++it) {
+        addColumn((*it)[1]);
+    }
+
+    if (selectList != "*") {
+        for (std::sregex_iterator it(selectList.begin(), selectList.end(), listItem), end; it != end; ++it) {
+            addColumn((*it)[1]);
+        }
+    }
+
+    if (columns.size() > kMaxIndexColumns) columns.resize(kMaxIndexColumns);
+    return !columns.empty() && isIdentifier(table);
+}
+
+std::string QueryAdvisor::shapeOf(const std::string& query) {
+    static const std::regex stringLiteral("'(?:[^'\\\\]|\\\\.)*'|\"(?:[^\"\\\\]|\\\\.)*\"");
+    static const std::regex numberLiteral("\\b\\d+(?:\\.\\d+)?\\b");
+
+    std::string shape = QueryCache::normalise(query);
+    shape = std::regex_replace(shape, stringLiteral, "?");
+    shape = std::regex_replace(shape, numberLiteral, "?");
+    return shape;
+}
+
+void QueryAdvisor::loadBaseline() {
+    std::ifstream in(baselineFile);
+    std::string line;
+    while (std::getline(in, line)) {
+        // Each line is "<0|1>\t<query shape>"
+        if (line.size() < 3 || line[1] != '\t') continue;
+        baseline[line.substr(2)] = line[0] == '1';
+    }
+}
+
+void QueryAdvisor::saveBaseline() {
+    std::ofstream out(baselineFile, std::ios::trunc);
+    if (!out) {
+        std::cerr << "Failed to write query plan baseline to " << baselineFile << std::endl;
+        return;
+    }
+    for (const auto& entry : baseline) {
+        out << (entry.second ? '1' : '0') << '\t' << entry.first << '\n';
+    }
+}
@@ -0,0 +1,63 @@
+#ifndef QUERY_ADVISOR_H
+#define QUERY_ADVISOR_H
+
+#include "databaseConnector.h"
+#include <map>
+#include <string>
+#include <vector>
+
+class QueryAdvisor {
+public:
+    // Summary of an EXPLAIN/ANALYZE FORMAT=JSON plan
+    struct PlanReport {
+        std::string query;
+        std::string table;          // First table in the plan
+        std::string key;            // Index chosen by the optimizer, empty if none
+        long long rows = -1;        // Estimated rows examined
+        bool fullScan = false;      // access_type ALL
+        bool filesort = false;
+        bool temporaryTable = false;
+
+        bool indexServed() const { return !fullScan && !filesort; }
+    };
+
+    QueryAdvisor(DatabaseConnector* dbConnector, const std::string& baselineFile);
+
+    // Run EXPLAIN (or ANALYZE, which executes the statement) and summarise the plan.
+    // ANALYZE is only used for read-only SELECTs; anything else falls back to EXPLAIN.
+    bool explain(const std::string& query, bool execute, PlanReport& report);
+
+    // Print the plan summary, any regression against the stored baseline, and an index suggestion
+    void review(const std::string& query, bool execute);
+
+    // Review each query without prompting and return those not served by an index.
+    // With printPlans false only regressions against the baseline are reported.
+    std::vector<std::string> reviewAll(const std::vector<std::string>& queries, bool printPlans);
+
+    // Offer to create the suggested index for each query
+    void offerIndexes(const std::vector<std::string>& queries);
+
+    // Suggest a covering index for a single-table SELECT; returns false if no suggestion applies
+    static bool suggestIndex(const std::string& query, std::string& table, std::vector<std::string>& columns);
+
+    // The query with literals replaced by '?', used to track plans across runs
+    static std::string shapeOf(const std::string& query);
+
+private:
+    void reportPlan(const PlanReport& report);
+    bool isRegression(const PlanReport& report) const;
+    bool checkBaseline(const PlanReport& report);
+    void offerIndex(const std::string& query);
+    bool createIndex(const std::string& table, const std::vector<std::string>& columns);
+
+    void loadBaseline();
+    void saveBaseline();
+
+    DatabaseConnector* dbConnector;
+    std::string baselineFile;
+
+    // Query shape -> whether it was served by an index the last time it was checked
+    std::map<std::string, bool> baseline;
+};
+
+#endif // QUERY_ADVISOR_H
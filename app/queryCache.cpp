@@ -0,0 +1,335 @@
+#include "queryCache.h"
+#include <algorithm>
+#include <cctype>
+
+namespace {
+    // Functions whose result changes between calls with identical SQL
+    const std::set<std::string> kNonDeterministic = {
+        "now", "sysdate", "curdate", "curtime", "current_date", "current_time",
+        "current_timestamp", "localtime", "localtimestamp", "utc_date", "utc_time",
+        "utc_timestamp", "unix_timestamp", "rand", "uuid", "uuid_short",
+        "last_insert_id", "connection_id", "found_rows", "row_count", "sleep",
+        "benchmark", "database", "user", "current_user", "session_user", "system_user",
+        // Sequences, named locks and random bytes change state or differ on every call
+        "nextval", "lastval", "setval", "get_lock", "release_lock", "release_all_locks",
+        "is_free_lock", "is_used_lock", "random_bytes", "sys_guid"
+    };
+
+    // The subset of the above that may also be written without parentheses
+    const std::set<std::string> kNonDeterministicKeywords = {
+        "current_date", "current_time", "current_timestamp", "current_user",
+        "localtime", "localtimestamp"
+    };
+
+    // Keywords that end a FROM/JOIN table list
+    const std::set<std::string> kClauseKeywords = {
+        "where", "group", "order", "limit", "having", "join", "inner", "left", "right",
+        "outer", "cross", "natural", "straight_join", "on", "using", "union", "window",
+        "for", "lock", "into", "set", "values", "select", "procedure"
+    };
+
+    // Statements that never modify data and so never invalidate anything
+    const std::set<std::string> kReadOnlyStatements = {
+        "select", "show", "describe", "desc", "explain", "analyze", "help"
+    };
+
+    bool isWordChar(char c) {
+        return std::isalnum(static_cast<unsigned char>(c)) || c == '_' || c == '$' || c == '.';
+    }
+
+    // Strip any "database." qualifier from a table name
+    std::string unqualified(const std::string& name) {
+        size_t dot = name.rfind('.');
+        return dot == std::string::npos ? name : name.substr(dot + 1);
+    }
+
+    // Index of the quote closing the string literal that opens at query[open], or npos.
+    // A backslash escapes the next character, so \' and \\ never end the literal.
+    size_t literalEnd(const std::string& query, size_t open) {
+        char quote = query[open];
+        for (size_t i = open + 1; i < query.size(); ++i) {
+            if (query[i] == '\\') {
+                ++i;
+            } else if (query[i] == quote) {
+                return i;
+            }
+        }
+        return std::string::npos;
+    }
+}
+
+QueryCache::QueryCache(size_t maxBytes, std::chrono::seconds ttl)
+    : maxBytes(maxBytes), ttl(ttl) {}
+
+std::string QueryCache::normalise(const std::string& query) {
+    std::string normalised;
+    normalised.reserve(query.size());
+
+    char quote = 0;
+    bool escaped = false;
+    bool pendingSpace = false;
+    for (char c : query) {
+        if (quote) {
+            // Literal contents are kept verbatim; an escaped quote does not close the literal
+            normalised += c;
+            if (escaped) {
+                escaped = false;
+            } else if (c == '\\' && quote != '`') {
+                escaped = true;
+            } else if (c == quote) {
+                quote = 0;
+            }
+            continue;
+        }
+        if (std::isspace(static_cast<unsigned char>(c))) {
+            pendingSpace = !normalised.empty();
+            continue;
+        }
+        if (pendingSpace) {
+            normalised += ' ';
+            pendingSpace = false;
+        }
+        if (c == '\'' || c == '"' || c == '`') quote = c;
+        normalised += c;
+    }
+
+    while (!normalised.empty() && (normalised.back() == ';' || normalised.back() == ' ')) {
+        normalised.pop_back();
+    }
+    return normalised;
+}
+
+std::vector<std::string> QueryCache::tokenize(const std::string& query) {
+    std::vector<std::string> tokens;
+    // True while the last token is an identifier that a following ".name" qualifies
+    bool afterIdentifier = false;
+    size_t i = 0;
+    while (i < query.size()) {
+        char c = query[i];
+        if (std::isspace(static_cast<unsigned char>(c))) {
+            ++i;
+            afterIdentifier = false;
+        } else if (c == '\'' || c == '"') {
+            // String literals collapse into a single placeholder token
+            size_t end = literalEnd(query, i);
+            i = end == std::string::npos ? query.size() : end + 1;
+            tokens.emplace_back("?");
+            afterIdentifier = false;
+        } else if (c == '`') {
+            size_t end = query.find('`', i + 1);
+            if (end == std::string::npos) end = query.size();
+            std::string word = query.substr(i + 1, end - i - 1);
+            std::transform(word.begin(), word.end(), word.begin(), ::tolower);
+            i = end + 1;
+            // Join db.`table` style qualifiers back onto the identifier
+            if (afterIdentifier && tokens.back().back() == '.') {
+                tokens.back() += word;
+            } else {
+                tokens.push_back(word);
+            }
+            afterIdentifier = true;
+        } else if (isWordChar(c)) {
+            size_t start = i;
+            while (i < query.size() && isWordChar(query[i])) ++i;
+            std::string word = query.substr(start, i - start);
+            std::transform(word.begin(), word.end(), word.begin(), ::tolower);
+            // Join `db`.table and `db`.`table` so the whole name reaches unqualified()
+            if (afterIdentifier && word[0] == '.') {
+                tokens.back() += word;
+            } else {
+                tokens.push_back(word);
+            }
+            afterIdentifier = true;
+        } else {
+            tokens.emplace_back(1, c);
+            ++i;
+            afterIdentifier = false;
+        }
+    }
+    return tokens;
+}
+
+std::set<std::string> QueryCache::referencedTables(const std::vector<std::string>& tokens) {
+    std::set<std::string> tables;
+    for (size_t i = 0; i < tokens.size(); ++i) {
+        const std::string& token = tokens[i];
+        bool listStart = token == "from" || token == "join" || token == "update" || token == "into";
+        if (token == "table" && i > 0) {
+            // TRUNCATE TABLE t, ALTER TABLE t, DROP TABLE t, RENAME TABLE t
+            listStart = true;
+        }
+        if (!listStart) continue;
+
+        // Walk a comma-separated table list, skipping aliases, until the next clause
+        bool expectTable = true;
+        for (size_t j = i + 1; j < tokens.size(); ++j) {
+            const std::string& next = tokens[j];
+            if (next == ",") {
+                expectTable = true;
+            } else if (next == "(" || next == ")" || next == ";" || kClauseKeywords.count(next)) {
+                break;
+            } else if (expectTable) {
+                if (next == "if" || next == "exists" || next == "not" || next == "low_priority" ||
+                    next == "ignore" || next == "quick") {
+                    continue;
+                }
+                if (isWordChar(next[0])) tables.insert(unqualified(next));
+                expectTable = false;
+            }
+        }
+    }
+    return tables;
+}
+
+bool QueryCache::isReadOnlySelect(const std::string& normalisedQuery) {
+    std::vector<std::string> tokens = tokenize(normalisedQuery);
+    if (tokens.empty() || tokens.front() != "select") return false;
+
+    for (size_t i = 0; i < tokens.size(); ++i) {
+        const std::string& token = tokens[i];
+        // User and system variables can be assigned and change between runs
+        if (token == "@") return false;
+        // Locking reads and SELECT ... INTO have side effects
+        if (token == "into" || token == "lock") return false;
+        if (token == "for" && i + 1 < tokens.size() && tokens[i + 1] == "update") return false;
+        // normalise strips a trailing semicolon, so any other one starts a second statement
+        if (token == ";") return false;
+    }
+    return true;
+}
+
+bool QueryCache::isCacheable(const std::string& normalisedQuery) {
+    if (!isReadOnlySelect(normalisedQuery)) return false;
+
+    std::vector<std::string> tokens = tokenize(normalisedQuery);
+    for (size_t i = 0; i < tokens.size(); ++i) {
+        const std::string& token = tokens[i];
+        // NEXT VALUE FOR / PREVIOUS VALUE FOR read or advance a sequence
+        if ((token == "next" || token == "previous") && i + 2 < tokens.size() &&
+            tokens[i + 1] == "value" && tokens[i + 2] == "for") {
+            return false;
+        }
+        // Only treat names as functions when called, so columns such as "user" stay cacheable
+        bool called = i + 1 < tokens.size() && tokens[i + 1] == "(";
+        if (kNonDeterministic.count(token) && (called || kNonDeterministicKeywords.count(token))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+size_t QueryCache::estimateBytes(const std::string& key, const Result& result) {
+    size_t bytes = sizeof(Entry) + key.size();
+    for (const auto& column : result.columns) {
+        bytes += sizeof(std::string) + column.size();
+    }
+    for (const auto& row : result.rows) {
+        bytes += sizeof(row);
+        for (const auto& value : row) {
+            bytes += sizeof(std::string) + value.size();
+        }
+    }
+    return bytes;
+}
+
+const QueryCache::Result* QueryCache::lookup(const std::string& key) {
+    auto found = index.find(key);
+    if (found == index.end()) {
+        ++stats.misses;
+        return nullptr;
+    }
+
+    auto it = found->second;
+    if (std::chrono::steady_clock::now() >= it->expires) {
+        erase(it);
+        ++stats.evictions;
+        ++stats.misses;
+        return nullptr;
+    }
+
+    // Move to the front of the LRU list
+    lru.splice(lru.begin(), lru, it);
+    ++stats.hits;
+    return &it->result;
+}
+
+void QueryCache::store(const std::string& key, const std::string& normalisedQuery, Result result) {
+    size_t bytes = estimateBytes(key, result);
+    if (bytes > maxBytes) return;  // Would evict everything else and still not fit
+
+    auto existing = index.find(key);
+    if (existing != index.end()) {
+        erase(existing->second);
+    }
+
+    while (stats.bytes + bytes > maxBytes && !lru.empty()) {
+        erase(std::prev(lru.end()));
+        ++stats.evictions;
+    }
+
+    Entry entry;
+    entry.key = key;
+    entry.result = std::move(result);
+    entry.tables = referencedTables(tokenize(normalisedQuery));
+    entry.bytes = bytes;
+    entry.expires = std::chrono::steady_clock::now() + ttl;
+
+    lru.push_front(std::move(entry));
+    index[key] = lru.begin();
+    stats.bytes += bytes;
+    stats.entries = lru.size();
+}
+
+void QueryCache::recordBypass() {
+    ++stats.bypasses;
+}
+
+void QueryCache::invalidateFor(const std::string& normalisedQuery) {
+    std::vector<std::string> tokens = tokenize(normalisedQuery);
+    if (tokens.empty() || kReadOnlyStatements.count(tokens.front())) return;
+
+    // Statements that may touch arbitrary tables (USE, CALL, LOAD DATA, ...) flush everything
+    const std::string& statement = tokens.front();
+    bool targeted = statement == "insert" || statement == "replace" || statement == "update" ||
+                    statement == "delete" || statement == "truncate" || statement == "alter" ||
+                    statement == "drop" || statement == "rename";
+
+    std::set<std::string> tables = referencedTables(tokens);
+    if (!targeted || tables.empty()) {
+        stats.invalidations += lru.size();
+        clear();
+        return;
+    }
+
+    for (const auto& table : tables) {
+        invalidateTable(table);
+    }
+}
+
+void QueryCache::invalidateTable(const std::string& table) {
+    std::string name = table;
+    std::transform(name.begin(), name.end(), name.begin(), ::tolower);
+
+    for (auto it = lru.begin(); it != lru.end();) {
+        auto next = std::next(it);
+        if (it->tables.count(name)) {
+            erase(it);
+            ++stats.invalidations;
+        }
+        it = next;
+    }
+}
+
+void QueryCache::clear() {
+    lru.clear();
+    index.clear();
+    stats.entries = 0;
+    stats.bytes = 0;
+}
+
+void QueryCache::erase(std::list<Entry>::iterator it) {
+    stats.bytes -= it->bytes;
+    index.erase(it->key);
+    lru.erase(it);
+    stats.entries = lru.size();
+}
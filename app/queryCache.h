@@ -0,0 +1,79 @@
+#ifndef QUERY_CACHE_H
+#define QUERY_CACHE_H
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class QueryCache {
+public:
+    // A fully materialised result set, as printed by DatabaseApp::executeQuery
+    struct Result {
+        std::vector<std::string> columns;
+        std::vector<std::vector<std::string>> rows;
+    };
+
+    struct Stats {
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        uint64_t bypasses = 0;       // Statements that are never cached
+        uint64_t evictions = 0;      // Entries dropped for space or age
+        uint64_t invalidations = 0;  // Entries dropped because a referenced table was written
+        size_t entries = 0;
+        size_t bytes = 0;
+    };
+
+    QueryCache(size_t maxBytes, std::chrono::seconds ttl);
+
+    // Collapse whitespace and drop trailing semicolons so trivially different
+    // spellings of the same statement share an entry
+    static std::string normalise(const std::string& query);
+
+    // SELECT statements without INTO, locking reads or variable assignments
+    static bool isReadOnlySelect(const std::string& normalisedQuery);
+
+    // Only deterministic read-only SELECT statements are cached
+    static bool isCacheable(const std::string& normalisedQuery);
+
+    // Returns nullptr on a miss; the pointer is valid until the next call that modifies the cache
+    const Result* lookup(const std::string& key);
+    void store(const std::string& key, const std::string& normalisedQuery, Result result);
+    void recordBypass();
+
+    // Drop every entry that may be stale after the given statement has run
+    void invalidateFor(const std::string& normalisedQuery);
+    void invalidateTable(const std::string& table);
+    void clear();
+
+    const Stats& getStats() const { return stats; }
+
+private:
+    struct Entry {
+        std::string key;
+        Result result;
+        std::set<std::string> tables;
+        size_t bytes;
+        std::chrono::steady_clock::time_point expires;
+    };
+
+    static std::vector<std::string> tokenize(const std::string& query);
+    static std::set<std::string> referencedTables(const std::vector<std::string>& tokens);
+    static size_t estimateBytes(const std::string& key, const Result& result);
+
+    void erase(std::list<Entry>::iterator it);
+
+    size_t maxBytes;
+    std::chrono::seconds ttl;
+
+    // Most recently used entries are at the front
+    std::list<Entry> lru;
+    std::unordered_map<std::string, std::list<Entry>::iterator> index;
+    Stats stats;
+};
+
+#endif // QUERY_CACHE_H
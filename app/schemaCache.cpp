@@ -0,0 +1,208 @@
+#include "schemaCache.h"
+#include "queryCache.h"
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <mariadb/mysql.h>
+#include <sstream>
+
+namespace {
+    const char* kHeaderPrefix = "# schema cache for ";
+
+    // All column metadata for the current database in a single round trip
+    const char* kColumnsQuery =
+        "SELECT TABLE_NAME, COLUMN_NAME, COLUMN_TYPE, IS_NULLABLE FROM information_schema.COLUMNS "
+        "WHERE TABLE_SCHEMA = DATABASE() ORDER BY TABLE_NAME, ORDINAL_POSITION";
+
+    std::string lowercase(std::string text) {
+        std::transform(text.begin(), text.end(), text.begin(), ::tolower);
+        return text;
+    }
+}
+
+SchemaCache::SchemaCache(const std::string& cacheFile, const std::string& host, const std::string& user,
+                         const std::string& database, std::chrono::seconds ttl)
+    : cacheFile(cacheFile), scope(user + "@" + host + "/" + database), ttl(ttl),
+      loaded(false), stale(true), backgroundConn(nullptr) {}
+
+SchemaCache::~SchemaCache() {
+    wait();
+    if (backgroundConn) {
+        mysql_close(backgroundConn);
+    }
+}
+
+void SchemaCache::wait() {
+    if (diskTask.valid()) diskTask.wait();
+    if (refreshTask.valid()) refreshTask.wait();
+}
+
+void SchemaCache::loadFromDiskAsync() {
+    if (diskTask.valid()) return;
+    diskTask = std::async(std::launch::async, [this]() { loadFromDisk(); });
+}
+
+void SchemaCache::loadFromDisk() {
+    std::ifstream in(cacheFile);
+    if (!in) return;
+
+    // Ignore caches written for a different account, server or database
+    std::string line;
+    if (!std::getline(in, line) || line != kHeaderPrefix + scope) return;
+
+    TableMap diskTables;
+    while (std::getline(in, line)) {
+        // Each line is "table\tcolumn\ttype\tnullable"
+        std::istringstream fields(line);
+        std::string table, nullable;
+        ColumnInfo column;
+        if (!std::getline(fields, table, '\t') || !std::getline(fields, column.name, '\t') ||
+            !std::getline(fields, column.type, '\t') || !std::getline(fields, nullable)) {
+            continue;
+        }
+        column.nullable = nullable == "1";
+        diskTables[table].push_back(column);
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    // A server refresh that finished first is newer than anything on disk
+    if (loaded) return;
+    tables.swap(diskTables);
+    loaded = true;
+    stale = true;
+}
+
+void SchemaCache::saveToDisk(const TableMap& snapshot) {
+    // Write a temporary file and rename it over the cache, so a concurrent reader
+    // (another instance, or our own disk load) never sees a half-written file
+    std::string tempFile = cacheFile + ".tmp";
+    {
+        std::ofstream out(tempFile, std::ios::trunc);
+        if (!out) {
+            std::cerr << "Failed to write schema cache to " << tempFile << std::endl;
+            return;
+        }
+
+        out << kHeaderPrefix << scope << '\n';
+        for (const auto& table : snapshot) {
+            for (const auto& column : table.second) {
+                out << table.first << '\t' << column.name << '\t' << column.type << '\t'
+                    << (column.nullable ? '1' : '0') << '\n';
+            }
+        }
+
+        if (!out.flush()) {
+            std::cerr << "Failed to write schema cache to " << tempFile << std::endl;
+            std::remove(tempFile.c_str());
+            return;
+        }
+    }
+
+    if (std::rename(tempFile.c_str(), cacheFile.c_str()) != 0) {
+        std::cerr << "Failed to replace schema cache " << cacheFile << std::endl;
+        std::remove(tempFile.c_str());
+    }
+}
+
+void SchemaCache::refreshAsync(DatabaseConnector* dbConnector) {
+    if (!dbConnector) return;
+
+    // Only one refresh at a time; a running one will pick up the latest schema anyway
+    if (refreshTask.valid() &&
+        refreshTask.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+        return;
+    }
+    refreshTask = std::async(std::launch::async, [this, dbConnector]() { refresh(dbConnector); });
+}
+
+void SchemaCache::refreshIfStale(DatabaseConnector* dbConnector) {
+    bool needsRefresh;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        needsRefresh = stale || std::chrono::steady_clock::now() - loadedAt > ttl;
+    }
+    if (needsRefresh) {
+        refreshAsync(dbConnector);
+    }
+}
+
+void SchemaCache::refresh(DatabaseConnector* dbConnector) {
+    mysql_thread_init();
+
+    try {
+        // The background connection is only opened the first time it is needed
+        if (!backgroundConn) {
+            backgroundConn = dbConnector->openConnection();
+        }
+
+        if (mysql_query(backgroundConn, kColumnsQuery)) {
+            std::cerr << "Schema refresh failed: " << mysql_error(backgroundConn) << std::endl;
+            // Reconnect on the next attempt in case the connection was dropped
+            mysql_close(backgroundConn);
+            backgroundConn = nullptr;
+            mysql_thread_end();
+            return;
+        }
+
+        MYSQL_RES* res = mysql_store_result(backgroundConn);
+        if (!res) {
+            std::cerr << "Failed to retrieve schema metadata: " << mysql_error(backgroundConn) << std::endl;
+            mysql_thread_end();
+            return;
+        }
+
+        TableMap serverTables;
+        MYSQL_ROW row;
+        while ((row = mysql_fetch_row(res))) {
+            if (!row[0] || !row[1]) continue;
+            ColumnInfo column;
+            column.name = row[1];
+            column.type = row[2] ? row[2] : "";
+            column.nullable = row[3] && std::string(row[3]) == "YES";
+            serverTables[row[0]].push_back(column);
+        }
+        mysql_free_result(res);
+
+        saveToDisk(serverTables);
+
+        std::lock_guard<std::mutex> lock(mutex);
+        tables.swap(serverTables);
+        loaded = true;
+        stale = false;
+        loadedAt = std::chrono::steady_clock::now();
+    } catch (const std::exception& e) {
+        std::cerr << "Schema refresh failed: " << e.what() << std::endl;
+    }
+
+    mysql_thread_end();
+}
+
+void SchemaCache::invalidate() {
+    std::lock_guard<std::mutex> lock(mutex);
+    stale = true;
+}
+
+bool SchemaCache::isSchemaChange(const std::string& query) {
+    std::string normalised = lowercase(QueryCache::normalise(query));
+    std::string statement = normalised.substr(0, normalised.find(' '));
+    return statement == "alter" || statement == "create" || statement == "drop" || statement == "rename";
+}
+
+bool SchemaCache::isLoaded() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return loaded;
+}
+
+bool SchemaCache::hasColumn(const std::string& table, const std::string& column) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto found = tables.find(table);
+    if (found == tables.end()) return false;
+
+    // Column names are case-insensitive in MySQL
+    std::string wanted = lowercase(column);
+    for (const auto& info : found->second) {
+        if (lowercase(info.name) == wanted) return true;
+    }
+    return false;
+}
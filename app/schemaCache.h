@@ -0,0 +1,65 @@
+#ifndef SCHEMA_CACHE_H
+#define SCHEMA_CACHE_H
+
+#include "databaseConnector.h"
+#include <chrono>
+#include <future>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+class SchemaCache {
+public:
+    struct ColumnInfo {
+        std::string name;
+        std::string type;
+        bool nullable;
+    };
+
+    SchemaCache(const std::string& cacheFile, const std::string& host, const std::string& user,
+                const std::string& database, std::chrono::seconds ttl);
+    ~SchemaCache();
+
+    // Read the persisted metadata in the background, e.g. while the user is logging in
+    void loadFromDiskAsync();
+
+    // Reload metadata from the server on a separate, lazily opened connection
+    void refreshAsync(DatabaseConnector* dbConnector);
+    void refreshIfStale(DatabaseConnector* dbConnector);
+
+    // Mark the metadata stale after a schema change made through the app
+    void invalidate();
+
+    // Block until background loads finish; call before the connector is destroyed
+    void wait();
+
+    // True for statements that may change table or column definitions
+    static bool isSchemaChange(const std::string& query);
+
+    bool isLoaded();
+    bool hasColumn(const std::string& table, const std::string& column);
+
+private:
+    typedef std::map<std::string, std::vector<ColumnInfo>> TableMap;
+
+    void loadFromDisk();
+    void saveToDisk(const TableMap& tables);
+    void refresh(DatabaseConnector* dbConnector);
+
+    std::string cacheFile;
+    std::string scope;  // user@host/database; visible columns depend on the account's privileges
+    std::chrono::seconds ttl;
+
+    std::mutex mutex;
+    TableMap tables;
+    bool loaded;
+    bool stale;
+    std::chrono::steady_clock::time_point loadedAt;
+
+    std::future<void> diskTask;
+    std::future<void> refreshTask;
+    MYSQL* backgroundConn;  // Only touched by the refresh task
+};
+
+#endif // SCHEMA_CACHE_H